@@ -0,0 +1,572 @@
+/*
+  Copyright (c) 2009 Dave Gamble
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+/* Benchmarks. Build and run with: make bench, or by hand: cc -O2 bench.c cJSON.c -o benchmark -lm -lpthread
+   Usage: benchmark [megabytes] [threads]
+
+   Each corpus is parsed, printed, duplicated, minified and deleted, and every figure is the best of several runs as
+   MB/s of the corpus text, so the numbers line up across operations and across versions. The generated corpora come
+   from a fixed seed, and the allocation counts are exact, so any change between two runs is the library's. */
+
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 199309L
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+#include <limits.h>
+#include "cJSON.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#ifdef USE_UNICODE
+#error The benchmarks generate narrow text: build them without USE_UNICODE.
+#endif
+
+/* Wall clock seconds: parallel runs spread their CPU time over several threads. */
+static double now(void)
+{
+#ifdef _WIN32
+	LARGE_INTEGER f,c;QueryPerformanceFrequency(&f);QueryPerformanceCounter(&c);
+	return (double)c.QuadPart/(double)f.QuadPart;
+#else
+	struct timespec t;clock_gettime(CLOCK_MONOTONIC,&t);
+	return t.tv_sec+t.tv_nsec/1e9;
+#endif
+}
+
+/* Every allocation the library makes goes through here, so each operation can report how many it made. */
+static unsigned long allocs,alloc_bytes;
+static void *counted_malloc(size_t sz)	{allocs++;alloc_bytes+=(unsigned long)sz;return malloc(sz);}
+
+/* A fixed sequence of pseudo-random numbers, so every run generates the same corpora. */
+static unsigned long seed;
+static unsigned long next(void)	{seed=seed*1103515245UL+12345UL;return (seed>>8)&0xffffff;}
+
+/* Room for at least want more bytes in *b, of which *o are used. */
+static int reserve(char **b,size_t *cap,size_t o,size_t want)
+{
+	char *n;
+	if (*cap-o>=want) return 1;
+	while (*cap-o<want) *cap*=2;
+	if (!(n=(char*)realloc(*b,*cap))) {free(*b);*b=0;return 0;}
+	*b=n;return 1;
+}
+
+/* About size bytes of one array holding rows of integers, decimals and exponents. */
+static char *numbers(size_t size,size_t *length)
+{
+	size_t cap=size+1024,o=0;char *b=(char*)malloc(cap);int i;
+	if (!b) return 0;
+	seed=1;b[o++]='[';
+	while (o<size)
+	{
+		if (!reserve(&b,&cap,o,512)) return 0;
+		o+=sprintf(b+o,"%s[",(o>1)?",":"");
+		for (i=0;i<8;i++) switch (i%4)
+		{
+			case 0: o+=sprintf(b+o,"%s%lu",i?",":"",next());break;
+			case 1: o+=sprintf(b+o,",-%lu.%03lu",next()%10000,next()%1000);break;
+			case 2: o+=sprintf(b+o,",%lu.%06lue%lu",next()%10,next()%1000000,next()%300);break;
+			default: o+=sprintf(b+o,",0.%lu",next());break;
+		}
+		b[o++]=']';
+	}
+	b[o++]=']';b[o]=0;*length=o;
+	return b;
+}
+
+/* About size bytes of one array of strings: plain text, escapes, and \u sequences including surrogate pairs. */
+static char *strings(size_t size,size_t *length)
+{
+	static const char *words[]={"lorem","ipsum","dolor","sit","amet","\\\\path\\\\to","\\\"quoted\\\"","tab\\there",
+		"line\\nbreak","caf\\u00e9","\\u6f22\\u5b57","\\ud83d\\ude00","\\/slash"};
+	size_t cap=size+1024,o=0;char *b=(char*)malloc(cap);int i,n;
+	if (!b) return 0;
+	seed=2;b[o++]='[';
+	while (o<size)
+	{
+		if (!reserve(&b,&cap,o,1024)) return 0;
+		o+=sprintf(b+o,"%s\"",(o>1)?",":"");
+		for (n=(int)(next()%24)+1,i=0;i<n;i++) o+=sprintf(b+o,"%s%s",i?" ":"",words[next()%(sizeof(words)/sizeof(*words))]);
+		b[o++]='"';
+	}
+	b[o++]=']';b[o]=0;*length=o;
+	return b;
+}
+
+/* About size bytes of one array of values nested 200 deep, alternating objects and arrays. */
+static char *deep(size_t size,size_t *length)
+{
+	size_t cap=size+4096,o=0;char *b=(char*)malloc(cap);int i;
+	if (!b) return 0;
+	seed=3;b[o++]='[';
+	while (o<size)
+	{
+		if (!reserve(&b,&cap,o,4096)) return 0;
+		if (o>1) b[o++]=',';
+		for (i=0;i<200;i++) o+=sprintf(b+o,(i&1)?"[":"{\"k%d\":",i);
+		o+=sprintf(b+o,"%lu",next());
+		for (i=199;i>=0;i--) b[o++]=(i&1)?']':'}';
+	}
+	b[o++]=']';b[o]=0;*length=o;
+	return b;
+}
+
+/* About size bytes of one object with a member per key, the values cycling through every type. */
+static char *wide(size_t size,size_t *length)
+{
+	size_t cap=size+1024,o=0,i;char *b=(char*)malloc(cap);
+	if (!b) return 0;
+	seed=4;b[o++]='{';
+	for (i=0;o<size;i++)
+	{
+		if (!reserve(&b,&cap,o,512)) return 0;
+		o+=sprintf(b+o,"%s\"member_%08lu\":",i?",":"",(unsigned long)i);
+		switch (i%5)
+		{
+			case 0: o+=sprintf(b+o,"%lu",next());break;
+			case 1: o+=sprintf(b+o,"\"value %lu\"",next());break;
+			case 2: o+=sprintf(b+o,"%s",(next()&1)?"true":"false");break;
+			case 3: o+=sprintf(b+o,"null");break;
+			default: o+=sprintf(b+o,"[%lu,{\"x\":%lu}]",next(),next());break;
+		}
+	}
+	b[o++]='}';b[o]=0;*length=o;
+	return b;
+}
+
+/* A whole file, or 0 if it can't be read. */
+static char *load(const char *path,size_t *length)
+{
+	FILE *f=fopen(path,"rb");long len;char *b;
+	if (!f) return 0;
+	fseek(f,0,SEEK_END);len=ftell(f);fseek(f,0,SEEK_SET);
+	if (len<0 || !(b=(char*)malloc(len+1))) {fclose(f);return 0;}
+	*length=fread(b,1,len,f);b[*length]=0;
+	fclose(f);
+	return b;
+}
+
+/* About size bytes of records, as one array or one per line. The same seed gives the same text on every run. */
+static char *records(size_t size,int ndjson,size_t *length)
+{
+	size_t cap=size+1024,o=0,i;char *b=(char*)malloc(cap),*n;unsigned long r=12345;
+	if (!b) return 0;
+	if (!ndjson) b[o++]='[';
+	for (i=0;o<size;i++)
+	{
+		if (cap-o<512) {if (!(n=(char*)realloc(b,cap*=2))) {free(b);return 0;} b=n;}
+		r=r*1103515245UL+12345UL;
+		o+=sprintf(b+o,"%s{\"id\":%lu,\"name\":\"user %lu\",\"active\":%s,\"score\":%lu.%02lu,"
+			"\"tags\":[\"a\",\"b\\\"c\"],\"address\":{\"city\":\"City %lu\",\"zip\":\"%05lu\"}}%s",
+			(!ndjson && i)?",":"",(unsigned long)i,(r>>8)%100000,(r&256)?"true":"false",(r>>4)%1000,r%100,(r>>12)%500,(r>>3)%100000,ndjson?"\n":"");
+	}
+	if (!ndjson) b[o++]=']';
+	b[o]=0;*length=o;
+	return b;
+}
+
+#define RUNS 5				/* best of this many. */
+#define MIN_WORK 1000000	/* small corpora are repeated until each run covers about this many bytes. */
+
+enum {op_parse,op_print,op_unformatted,op_duplicate,op_minify,op_loop_minify,op_delete,op_count};
+static const char *op_names[op_count]={"Parse","Print","PrintUnformatted","Duplicate","Minify","Minify w/ loop","Delete"};
+
+/* The minifier cJSON had before cJSON_MinifyWithLength, verbatim: a PFCHAR at a time to the terminator. Kept here so the
+current one is measured against it. */
+static void loop_minify(char *json)
+{
+	char *into=json;
+	while (*json)
+	{
+		if (*json==' ') json++;
+		else if (*json=='\t') json++;	/* Whitespace characters. */
+		else if (*json=='\r') json++;
+		else if (*json=='\n') json++;
+		else if (*json=='/' && json[1]=='/')  while (*json && *json!='\n') json++;	/* double-slash comments, to end of line. */
+		else if (*json=='/' && json[1]=='*') {while (*json && !(*json=='*' && json[1]=='/')) json++;json+=2;}	/* multiline comments. */
+		else if (*json=='\"'){*into++=*json++;while (*json && *json!='\"'){if (*json=='\\') *into++=*json++;*into++=*json++;}*into++=*json++;} /* string literals, which are \" sensitive. */
+		else *into++=*json++;			/* All other characters. */
+	}
+	*into=0;	/* and null-terminate. */
+}
+
+/* Time every operation over one corpus, and print a line for each: MB/s, then allocations and bytes per call. Every
+repetition gets its own tree or copy of the text, so no run sees a cache another has warmed up for it. */
+static void suite(const char *name,const char *text,size_t length)
+{
+	int reps=(length>=MIN_WORK)?1:(int)((MIN_WORK+length-1)/length),r,run,op;
+	double best[op_count],took;unsigned long count[op_count],bytes[op_count],a,ab;
+	cJSON **trees=(cJSON**)malloc(reps*sizeof(cJSON*)),**copies=(cJSON**)malloc(reps*sizeof(cJSON*));
+	char *scratch=(char*)malloc(reps*(length+1)),*out;
+
+	if (!trees || !copies || !scratch) {free(trees);free(copies);free(scratch);printf("%-12s out of memory\n",name);return;}
+	for (op=0;op<op_count;op++) best[op]=-1,count[op]=bytes[op]=0;
+	for (run=0;run<RUNS;run++)
+	{
+#define TIME(op,body) a=allocs;ab=alloc_bytes;took=now();body;took=now()-took; \
+		if (best[op]<0 || took<best[op]) best[op]=took; count[op]=allocs-a;bytes[op]=alloc_bytes-ab;
+		TIME(op_parse,for (r=0;r<reps;r++) trees[r]=cJSON_Parse(text))
+		if (!trees[0]) {printf("%-12s parse failed\n",name);break;}
+		TIME(op_print,for (r=0;r<reps;r++) {out=cJSON_Print(trees[r]);free(out);})
+		TIME(op_unformatted,for (r=0;r<reps;r++) {out=cJSON_PrintUnformatted(trees[r]);free(out);})
+		TIME(op_duplicate,for (r=0;r<reps;r++) copies[r]=cJSON_Duplicate(trees[r],1))
+		for (r=0;r<reps;r++) {cJSON_Delete(copies[r]);memcpy(scratch+r*(length+1),text,length+1);}
+		TIME(op_minify,for (r=0;r<reps;r++) cJSON_MinifyWithLength(scratch+r*(length+1),length))
+		for (r=0;r<reps;r++) memcpy(scratch+r*(length+1),text,length+1);
+		TIME(op_loop_minify,for (r=0;r<reps;r++) loop_minify(scratch+r*(length+1)))
+		TIME(op_delete,for (r=0;r<reps;r++) cJSON_Delete(trees[r]))
+#undef TIME
+	}
+	if (run==RUNS) for (op=0;op<op_count;op++)
+		printf("%-12s %-16s %9.1f MB/s %10.1f allocs %12.1f bytes\n",name,op_names[op],
+			(double)length*reps/1e6/best[op],(double)count[op]/reps,(double)bytes[op]/reps);
+	free(trees);free(copies);free(scratch);
+}
+
+/* The same records as cJSON_Print lays them out, whitespace making up a good part of the text. The two parses build
+the same tree, so best of RUNS of each in milliseconds shows what skipping the whitespace costs. */
+static void pretty(const char *text,size_t length)
+{
+	cJSON *c=cJSON_ParseWithLength(text,length);char *out=c?cJSON_Print(c):0;int run,which;double best[2]={-1,-1},took;
+	cJSON_Delete(c);
+	if (!out) {printf("%-12s out of memory\n","pretty");return;}
+	suite("pretty",out,strlen(out));
+	for (run=0;run<RUNS;run++) for (which=0;which<2;which++)
+	{
+		took=now();
+		c=which?cJSON_Parse(out):cJSON_ParseWithLength(text,length);
+		took=now()-took;
+		if (best[which]<0 || took<best[which]) best[which]=took;
+		cJSON_Delete(c);
+	}
+	printf("%-12s %-16s %9.1f ms compact %9.1f ms pretty (%.2fx)\n","pretty","Parse vs compact",best[0]*1e3,best[1]*1e3,best[1]/best[0]);
+	free(out);
+}
+
+/* Best of RUNS full parses against parses projected down to two fields of each record, with allocations per parse. */
+static void projection(const char *text,size_t length)
+{
+	static const char *fields[]={"/id","/address/city"};
+	cJSON_Projection *proj=cJSON_CompileProjection(fields,2,0);int run,which;double best[2]={-1,-1},took;unsigned long count[2],a;cJSON *c;
+	if (!proj) return;
+	for (run=0;run<RUNS;run++) for (which=0;which<2;which++)
+	{
+		a=allocs;took=now();
+		c=which?cJSON_ParseProjectedWithLength(proj,text,length):cJSON_ParseWithLength(text,length);
+		took=now()-took;count[which]=allocs-a;
+		if (best[which]<0 || took<best[which]) best[which]=took;
+		cJSON_Delete(c);
+	}
+	printf("Projection to %s and %s, %.1f MB\n",fields[0],fields[1],length/1e6);
+	printf("  full      %9.1f MB/s %10lu allocs\n",length/1e6/best[0],count[0]);
+	printf("  projected %9.1f MB/s %10lu allocs\n",length/1e6/best[1],count[1]);
+	cJSON_DeleteProjection(proj);
+}
+
+/* Visit every value under a tree, compact node or tape position, adding up the numbers so the walk can't be skipped. */
+static double walked;
+static unsigned long walk_tree(cJSON *c)
+{
+	unsigned long n=1;
+	if (c->type==cJSON_Number) walked+=c->valuedouble;
+	for (c=c->child;c;c=c->next) n+=walk_tree(c);
+	return n;
+}
+static unsigned long walk_compact(cJSON_Compact *doc,cJSON_Node node)
+{
+	unsigned long n=1;
+	if (cJSON_GetCompactType(doc,node)==cJSON_Number) walked+=cJSON_GetCompactNumber(doc,node);
+	for (node=cJSON_GetCompactChild(doc,node);node;node=cJSON_GetCompactNext(doc,node)) n+=walk_compact(doc,node);
+	return n;
+}
+static unsigned long walk_tape(cJSON_Tape *tape,cJSON_Node node)
+{
+	unsigned long n=1;
+	if (cJSON_GetTapeType(tape,node)==cJSON_Number) walked+=cJSON_GetTapeNumber(tape,node);
+	for (node=cJSON_GetTapeChild(tape,node);node;node=cJSON_GetTapeNext(tape,node)) n+=walk_tape(tape,node);
+	return n;
+}
+
+/* Best of RUNS parses of the records into a tree, a compact document and a tape, and walks over each: MB/s, millions of
+values a second, and the bytes each holds against the text. For the tree that is what the parse asks malloc for. */
+static void read_only(const char *text,size_t length)
+{
+	static const char *names[3]={"tree","compact","tape"};
+	int run,which;double best[3][2],took;size_t bytes[3]={0,0,0};unsigned long nodes=0,a;
+	cJSON *c=0;cJSON_Compact *doc=0;cJSON_Tape *tape=0;
+	for (which=0;which<3;which++) best[which][0]=best[which][1]=-1;
+	for (run=0;run<RUNS;run++) for (which=0;which<3;which++)
+	{
+		a=alloc_bytes;took=now();
+		if (which==0) c=cJSON_ParseWithLength(text,length);
+		else if (which==1) doc=cJSON_ParseCompactWithLength(text,length);
+		else tape=cJSON_ParseTapeWithLength(text,length);
+		took=now()-took;if (best[which][0]<0 || took<best[which][0]) best[which][0]=took;
+		if (!c && !doc && !tape) {printf("%s parse failed\n",names[which]);return;}
+		bytes[which]=(which==0)?alloc_bytes-a:(which==1)?cJSON_GetCompactMemory(doc):cJSON_GetTapeMemory(tape);
+		took=now();
+		nodes=(which==0)?walk_tree(c):(which==1)?walk_compact(doc,cJSON_GetCompactRoot(doc)):walk_tape(tape,cJSON_GetTapeRoot(tape));
+		took=now()-took;if (best[which][1]<0 || took<best[which][1]) best[which][1]=took;
+		cJSON_Delete(c);cJSON_DeleteCompact(doc);cJSON_DeleteTape(tape);c=0;doc=0;tape=0;
+	}
+	printf("Read-only forms, %.1f MB, %lu values\n",length/1e6,nodes);
+	for (which=0;which<3;which++)
+		printf("  %-9s %9.1f MB/s parse %9.1f Mvalues/s walk %9.1f MB held (%.2fx the text)\n",names[which],
+			length/1e6/best[which][0],nodes/1e6/best[which][1],bytes[which]/1e6,(double)bytes[which]/length);
+}
+
+/* The number conversion cJSON had before it parsed numbers exactly: digits accumulated in a double, then scaled with
+pow(). Kept here so the current parser is measured against it. */
+static double pow_number(const char *num)
+{
+	double n=0,sign=1,scale=0;int subscale=0,signsubscale=1;
+	if (*num=='-') sign=-1,num++;
+	if (*num=='0') num++;
+	if (*num>='1' && *num<='9') do n=(n*10.0)+(*num++ -'0'); while (*num>='0' && *num<='9');
+	if (*num=='.' && num[1]>='0' && num[1]<='9') {num++;do n=(n*10.0)+(*num++ -'0'),scale--; while (*num>='0' && *num<='9');}
+	if (*num=='e' || *num=='E')
+	{
+		num++;if (*num=='+') num++; else if (*num=='-') signsubscale=-1,num++;
+		while (*num>='0' && *num<='9') subscale=(subscale*10)+(*num++ -'0');
+	}
+	return sign*n*pow(10.0,(scale+subscale*signsubscale));
+}
+
+/* count number literals, each followed by its terminator: the mix the numbers corpus has, or 17 significant digits,
+which is what printing a double exactly takes and what defeats the fast path. */
+static char *literals(int count,int long_mantissa,size_t *length)
+{
+	size_t cap=(size_t)count*32+1,o=0;char *b=(char*)malloc(cap);int i;double d;
+	if (!b) return 0;
+	seed=2;
+	for (i=0;i<count;i++)
+	{
+		if (long_mantissa)
+		{
+			d=((double)next()*16777216.0+next())/281474976710656.0*pow(10.0,(double)(next()%41)-20.0);
+			o+=sprintf(b+o,"%s%.17g",(next()&1)?"-":"",d);
+		}
+		else switch (i%4)
+		{
+			case 0: o+=sprintf(b+o,"%lu",next());break;
+			case 1: o+=sprintf(b+o,"-%lu.%03lu",next()%10000,next()%1000);break;
+			case 2: o+=sprintf(b+o,"%lu.%06lue%lu",next()%10,next()%1000000,next()%300);break;
+			default: o+=sprintf(b+o,"0.%lu",next());break;
+		}
+		b[o++]=0;
+	}
+	*length=o;
+	return b;
+}
+
+/* Best of RUNS conversions of every literal, as millions of numbers a second, by cJSON_ParseInArena and by the parser
+before it, and how many of the values each gets wrong against strtod. The earlier parser differed only in conversion,
+so its time is what parsing "0" that many times takes, for the item and the dispatch, plus pow_number's. */
+static volatile double number_sink;
+static void number_conversion(const char *name,int count,int long_mantissa)
+{
+	size_t length;char *text=literals(count,long_mantissa,&length),*p;cJSON_Arena *arena=cJSON_CreateArena(0,0);
+	int run,i,wrong[2]={0,0};double best[3]={-1,-1,-1},took,sum;cJSON *c;
+	if (!text || !arena) {free(text);cJSON_DeleteArena(arena);printf("%-12s out of memory\n",name);return;}
+	for (p=text,i=0;i<count;i++,p+=strlen(p)+1)
+	{
+		c=cJSON_ParseInArena(arena,p);
+		if (!c || c->valuedouble!=strtod(p,0)) wrong[0]++;
+		if (pow_number(p)!=strtod(p,0)) wrong[1]++;
+		if (!(i&4095)) cJSON_ResetArena(arena);
+	}
+	for (run=0;run<RUNS;run++)
+	{
+		cJSON_ResetArena(arena);
+		took=now();
+		for (p=text,i=0;i<count;i++,p+=strlen(p)+1) {cJSON_ParseInArena(arena,p);if (!(i&4095)) cJSON_ResetArena(arena);}
+		took=now()-took;if (best[0]<0 || took<best[0]) best[0]=took;
+		took=now();
+		for (p=text,i=0;i<count;i++,p+=strlen(p)+1) {cJSON_ParseInArena(arena,"0");if (!(i&4095)) cJSON_ResetArena(arena);}
+		took=now()-took;if (best[1]<0 || took<best[1]) best[1]=took;
+		took=now();
+		for (sum=0,p=text,i=0;i<count;i++,p+=strlen(p)+1) sum+=pow_number(p);
+		took=now()-took;if (best[2]<0 || took<best[2]) best[2]=took;
+		number_sink=sum;
+	}
+	printf("%-12s %-16s %9.1f M/s %10d of %d wrong\n",name,"Parse numbers",count/1e6/best[0],wrong[0],count);
+	printf("%-12s %-16s %9.1f M/s %10d of %d wrong\n",name,"Parse with pow()",count/1e6/(best[1]+best[2]),wrong[1],count);
+	cJSON_DeleteArena(arena);free(text);
+}
+
+/* The number printing cJSON had before it printed the shortest round trip, verbatim but for the allocator and for taking
+the double: a buffer per number and one of four printf formats. Kept here so the current printer is measured against it. */
+static char *sprintf_number(double d)
+{
+	char *str;int valueint=(int)d;
+	if (fabs(((double)valueint)-d)<=DBL_EPSILON && d<=INT_MAX && d>=INT_MIN)
+	{
+		str=(char*)malloc(21);	/* 2^64+1 can be represented in 21 chars. */
+		if (str) sprintf(str,"%d",valueint);
+	}
+	else
+	{
+		str=(char*)malloc(64);	/* This is a nice tradeoff. */
+		if (str)
+		{
+			if (fabs(floor(d)-d)<=DBL_EPSILON && fabs(d)<1.0e60)sprintf(str,"%.0f",d);
+			else if (fabs(d)<1.0e-6 || fabs(d)>1.0e9)			sprintf(str,"%e",d);
+			else												sprintf(str,"%f",d);
+		}
+	}
+	return str;
+}
+
+/* Best of RUNS prints of an array of the literals' values, as millions of numbers a second, by cJSON_PrintUnformatted and
+by the printer before it, and how many values each prints in a way that doesn't read back the same. The earlier printer
+differed only in the numbers, so its time is what printing as many zeros takes plus sprintf_number's. */
+static void print_conversion(const char *name,int count,int long_mantissa)
+{
+	size_t length;char *text=literals(count,long_mantissa,&length),*p,*out;double *values=(double*)malloc(count*sizeof(double));
+	cJSON *array=cJSON_CreateArray(),*zeros=cJSON_CreateArray(),*back,*c;int run,i,wrong[2]={0,0};double best[3]={-1,-1,-1},took;
+	if (!text || !values || !array || !zeros) {free(text);free(values);cJSON_Delete(array);cJSON_Delete(zeros);printf("%-12s out of memory\n",name);return;}
+	for (p=text,i=0;i<count;i++,p+=strlen(p)+1)
+	{
+		values[i]=strtod(p,0);
+		cJSON_AddItemToArray(array,cJSON_CreateNumber(values[i]));
+		cJSON_AddItemToArray(zeros,cJSON_CreateNumber(0));
+		out=sprintf_number(values[i]);
+		if (!out || strtod(out,0)!=values[i]) wrong[1]++;
+		free(out);
+	}
+	out=cJSON_PrintUnformatted(array);back=out?cJSON_Parse(out):0;
+	for (c=back?back->child:0,i=0;i<count;i++,c=c?c->next:0) if (!c || c->valuedouble!=values[i]) wrong[0]++;
+	cJSON_Delete(back);free(out);
+	for (run=0;run<RUNS;run++)
+	{
+		took=now();out=cJSON_PrintUnformatted(array);took=now()-took;free(out);
+		if (best[0]<0 || took<best[0]) best[0]=took;
+		took=now();out=cJSON_PrintUnformatted(zeros);took=now()-took;free(out);
+		if (best[1]<0 || took<best[1]) best[1]=took;
+		took=now();
+		for (i=0;i<count;i++) free(sprintf_number(values[i]));
+		took=now()-took;if (best[2]<0 || took<best[2]) best[2]=took;
+	}
+	printf("%-12s %-16s %9.1f M/s %10d of %d wrong\n",name,"Print numbers",count/1e6/best[0],wrong[0],count);
+	printf("%-12s %-16s %9.1f M/s %10d of %d wrong\n",name,"Print w/ printf()",count/1e6/(best[1]+best[2]),wrong[1],count);
+	cJSON_Delete(array);cJSON_Delete(zeros);free(values);free(text);
+}
+
+/* Best of three parses with each thread count, as MB/s and speedup over one thread. */
+static void scaling(const char *name,const char *text,size_t length,int maxthreads,cJSON *(*parse)(const char*,size_t,int))
+{
+	int t,run;double best,took,base=0;cJSON *c;
+	printf("%s, %.1f MB\n",name,length/1e6);
+	cJSON_Delete(parse(text,length,1));	/* warm the allocator, so the first count doesn't get fresh memory the others don't. */
+	for (t=1;t<=maxthreads;t++)
+	{
+		for (best=-1,run=0;run<3;run++)
+		{
+			took=now();c=parse(text,length,t);took=now()-took;
+			if (best<0 || took<best) best=took;
+			if (!c) {printf("  parse failed\n");return;}
+			cJSON_Delete(c);
+		}
+		if (t==1) base=best;
+		printf("  %2d threads %9.1f MB/s %6.2fx\n",t,length/1e6/best,base/best);
+	}
+}
+
+/* Best of three times to parse text nested to the limit many times over, then to duplicate, print and delete one
+tree far deeper than that. */
+static void nesting(int count)
+{
+	int depth=CJSON_NESTING_LIMIT,i,run;double best[4],took;char *text=(char*)malloc(2*depth+1),*out;cJSON *root,*item,*copy;
+	if (!text) return;
+	memset(text,'[',depth);memset(text+depth,']',depth);text[2*depth]=0;
+	for (i=0;i<4;i++) best[i]=-1;
+	for (run=0;run<3;run++)
+	{
+		took=now();
+		for (i=0;i<count;i++) cJSON_Delete(cJSON_Parse(text));
+		took=now()-took;if (best[0]<0 || took<best[0]) best[0]=took;
+
+		root=item=cJSON_CreateArray();
+		for (i=1;i<count*depth;i++) {cJSON_AddItemToArray(item,cJSON_CreateArray());item=item->child;}
+		took=now();copy=cJSON_Duplicate(root,1);took=now()-took;if (best[1]<0 || took<best[1]) best[1]=took;
+		took=now();out=cJSON_PrintUnformatted(copy);took=now()-took;if (best[2]<0 || took<best[2]) best[2]=took;
+		free(out);cJSON_Delete(copy);
+		took=now();cJSON_Delete(root);took=now()-took;if (best[3]<0 || took<best[3]) best[3]=took;
+	}
+	printf("Nesting, %d texts %d deep, one tree %d deep\n",count,depth,count*depth);
+	printf("  parse     %9.1f MB/s\n",count*2.0*depth/1e6/best[0]);
+	printf("  duplicate %9.1f Mnodes/s\n",count*depth/1e6/best[1]);
+	printf("  print     %9.1f MB/s\n",count*2.0*depth/1e6/best[2]);
+	printf("  delete    %9.1f Mnodes/s\n",count*depth/1e6/best[3]);
+	free(text);
+}
+
+int main(int argc,char **argv)
+{
+	static const char *files[]={"tests/test1","tests/test2","tests/test3","tests/test4","tests/test5"};
+	static char *(*const generators[])(size_t,size_t*)={numbers,strings,deep,wide};
+	static const char *generated[]={"numbers","strings","deep","wide"};
+	size_t mb=(argc>1)?(size_t)atol(argv[1]):8,length;int threads=(argc>2)?atoi(argv[2]):8,i;char *text;
+	cJSON_Hooks hooks;
+
+	hooks.malloc_fn=counted_malloc;hooks.free_fn=free;
+	cJSON_InitHooks(&hooks);
+	for (i=0;i<(int)(sizeof(generators)/sizeof(*generators));i++)
+	{
+		if (!(text=generators[i](mb*1000000,&length))) return 1;
+		suite(generated[i],text,length);
+		free(text);
+	}
+	if (!(text=records(mb*1000000,0,&length))) return 1;
+	suite("records",text,length);
+	pretty(text,length);
+	free(text);
+	for (i=0;i<(int)(sizeof(files)/sizeof(*files));i++)
+	{
+		if (!(text=load(files[i],&length))) {printf("%-12s missing\n",files[i]);continue;}
+		suite(files[i]+6,text,length);
+		free(text);
+	}
+
+	number_conversion("numbers",(int)mb*125000,0);
+	number_conversion("long digits",(int)mb*125000,1);
+	print_conversion("numbers",(int)mb*125000,0);
+	print_conversion("long digits",(int)mb*125000,1);
+
+	if (!(text=records(mb*1000000,0,&length))) return 1;
+	projection(text,length);
+	read_only(text,length);
+	scaling("cJSON_ParseParallel",text,length,threads,cJSON_ParseParallel);
+	free(text);
+	if (!(text=records(mb*1000000,1,&length))) return 1;
+	scaling("cJSON_ParseNDJSONParallel",text,length,threads,cJSON_ParseNDJSONParallel);
+	free(text);
+	nesting(1000);
+	return 0;
+}
@@ -23,6 +23,9 @@
 /* cJSON */
 /* JSON parser in C. */
 
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+	#define _POSIX_C_SOURCE 199309L	/* clock_gettime, for cJSON_Stats. */
+#endif
 #include <string.h>
 #include <stdio.h>
 #include <math.h>
@@ -30,13 +33,47 @@
 #include <float.h>
 #include <limits.h>
 #include <ctype.h>
+#include <locale.h>
 #include "cJSON.h"
 
+/* SSE2 string scanning: always there on x86-64, opt out with CJSON_NO_SIMD. Wide PFCHARs scan one at a time. */
+#if !defined(CJSON_NO_SIMD) && !defined(USE_UNICODE) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP>=2))
+	#define CJSON_SSE2
+	#include <emmintrin.h>
+#endif
+
+/* Parallel parsing runs on POSIX threads or Win32 threads; CJSON_NO_THREADS parses the chunks one after another. */
+#if !defined(CJSON_NO_THREADS) && defined(_WIN32)
+	#include <windows.h>
+#elif !defined(CJSON_NO_THREADS)
+	#include <pthread.h>
+#endif
+
+/* Record readers and print sinks use file descriptors. */
+#include <errno.h>
+#ifdef _WIN32
+	#include <io.h>
+	#define read_fd(fd,buf,n) _read(fd,buf,(unsigned)(n))
+	#define write_fd(fd,buf,n) _write(fd,buf,(unsigned)(n))
+#else
+	#include <unistd.h>
+	#define read_fd(fd,buf,n) read(fd,buf,n)
+	#define write_fd(fd,buf,n) write(fd,buf,n)
+#endif
+
+/* Statistics are timed on a monotonic clock where there is one. */
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <time.h>
+#endif
+
 #ifdef _WIN32
 	#include <tchar.h>
 	#define strlen _tcslen
 	#define strcpy _tcscpy 
 	#define strncmp _tcsncmp
+	#define strcmp _tcscmp
 	#define sprintf _stprintf
 	#define strchr _tcschr
 #else
@@ -49,7 +86,8 @@ const PFCHAR *cJSON_GetErrorPtr(void) {return ep;}
 
 static int cJSON_strcasecmp(const PFCHAR *s1,const PFCHAR *s2)
 {
-	if (!s1) return (s1==s2)?0:1;if (!s2) return 1;
+	if (!s1) return (s1==s2)?0:1;
+	if (!s2) return 1;
 	for(; tolower(*s1) == tolower(*s2); ++s1, ++s2)	if(*s1 == 0)	return 0;
 	return tolower(*(const UPFCHAR *)s1) - tolower(*(const UPFCHAR *)s2);
 }
@@ -57,18 +95,6 @@ static int cJSON_strcasecmp(const PFCHAR *s1,const PFCHAR *s2)
 static void *(*cJSON_malloc)(size_t sz) = malloc;
 static void (*cJSON_free)(void *ptr) = free;
 
-static PFCHAR* cJSON_strdup(const PFCHAR* str)
-{
-      size_t len;
-      PFCHAR* copy;
-
-      len = strlen(str) + 1;
-      if (!(copy = (PFCHAR*)cJSON_malloc(len*sizeof(PFCHAR)))) return 0;
-	  memset(copy,0,len*sizeof(PFCHAR));
-      memcpy(copy,str,len*sizeof(PFCHAR));
-      return copy;
-}
-
 void cJSON_InitHooks(cJSON_Hooks* hooks)
 {
     if (!hooks) { /* Reset hooks */
@@ -81,6 +107,141 @@ void cJSON_InitHooks(cJSON_Hooks* hooks)
 	cJSON_free	 = (hooks->free_fn)?hooks->free_fn:free;
 }
 
+/* Lookup index over the children of an array or object: the children in order, plus for objects an
+open-addressed table hashed on the case-folded key. Keys go in in list order and are never moved,
+so the first match along a probe is the first match in the list. */
+struct cJSON_Index
+{
+	cJSON **items;		/* the children in order; 0 while it needs rebuilding. */
+	size_t count,capacity;
+	cJSON **slots;		/* objects only: the key table; 0 while it needs rebuilding. */
+	size_t mask;		/* capacity-1; capacity is a power of two. */
+	size_t used;		/* live entries plus tombstones. */
+};
+static cJSON index_tombstone;	/* fills the slot of a detached child so probes carry on past it. */
+
+static size_t index_hash(const PFCHAR *s)
+{
+	size_t h=2166136261u;
+	while (*s) h=(h^(size_t)tolower(*s++))*16777619u;
+	return h;
+}
+
+static void index_insert(struct cJSON_Index *ix,cJSON *item)
+{
+	size_t i=index_hash(item->string)&ix->mask;
+	while (ix->slots[i]) i=(i+1)&ix->mask;
+	ix->slots[i]=item;ix->used++;
+}
+
+static void index_free(struct cJSON_Index *ix)	{if (ix) {cJSON_free(ix->items);cJSON_free(ix->slots);cJSON_free(ix);}}
+static void index_stale_items(struct cJSON_Index *ix)	{if (ix && ix->items) {cJSON_free(ix->items);ix->items=0;}}
+static void index_stale_keys(struct cJSON_Index *ix)	{if (ix && ix->slots) {cJSON_free(ix->slots);ix->slots=0;}}
+
+static struct cJSON_Index *index_get(cJSON *item)
+{
+	if (!item->index && (item->index=(struct cJSON_Index*)cJSON_malloc(sizeof(struct cJSON_Index))))
+		memset(item->index,0,sizeof(struct cJSON_Index));
+	return item->index;
+}
+
+/* (Re)build the ordered vector of children. */
+static int index_build_items(cJSON *array)
+{
+	struct cJSON_Index *ix=index_get(array);cJSON *c;size_t n=0;
+	if (!ix) return 0;
+	for (c=array->child;c;c=c->next) n++;
+	index_stale_items(ix);
+	ix->capacity=n?n:4;
+	if (!(ix->items=(cJSON**)cJSON_malloc(ix->capacity*sizeof(cJSON*)))) return 0;	/* stays stale; callers fall back to walking. */
+	for (n=0,c=array->child;c;c=c->next) ix->items[n++]=c;
+	ix->count=n;
+	return 1;
+}
+
+/* (Re)build the key table over the children of object, at most half full. */
+static int index_build_keys(cJSON *object)
+{
+	struct cJSON_Index *ix=index_get(object);cJSON *c;size_t n=0,cap=8;
+	if (!ix) return 0;
+	for (c=object->child;c;c=c->next) n++;
+	while (cap<2*n+2) cap*=2;
+	index_stale_keys(ix);
+	if (!(ix->slots=(cJSON**)cJSON_malloc(cap*sizeof(cJSON*)))) return 0;
+	memset(ix->slots,0,cap*sizeof(cJSON*));
+	ix->mask=cap-1;ix->used=0;
+	for (c=object->child;c;c=c->next) if (c->string) index_insert(ix,c);
+	return 1;
+}
+
+/* Find the slot holding the first child keyed string, rebuilding a stale table first. */
+static cJSON **index_find(cJSON *object,const PFCHAR *string,int case_sensitive)
+{
+	struct cJSON_Index *ix=object->index;size_t i;cJSON *c;
+	if (!ix->slots && !index_build_keys(object)) return 0;
+	for (i=index_hash(string)&ix->mask;(c=ix->slots[i]);i=(i+1)&ix->mask)
+		if (c!=&index_tombstone && !(case_sensitive?strcmp(c->string,string):cJSON_strcasecmp(c->string,string))) return &ix->slots[i];
+	return 0;
+}
+
+/* Find the slot holding exactly item. */
+static cJSON **index_slot_of(struct cJSON_Index *ix,cJSON *item)
+{
+	size_t i;
+	if (!ix || !ix->slots || !item->string) return 0;
+	for (i=index_hash(item->string)&ix->mask;ix->slots[i];i=(i+1)&ix->mask) if (ix->slots[i]==item) return &ix->slots[i];
+	return 0;
+}
+
+/* Keep the index in step with a child appended to container. */
+static void index_append(cJSON *container,cJSON *item)
+{
+	struct cJSON_Index *ix=container->index;cJSON **grown;
+	if (ix->items && ix->count==ix->capacity)
+	{
+		if ((grown=(cJSON**)cJSON_malloc(2*ix->capacity*sizeof(cJSON*))))
+		{
+			memcpy(grown,ix->items,ix->count*sizeof(cJSON*));
+			ix->capacity*=2;
+		}
+		cJSON_free(ix->items);ix->items=grown;	/* on failure this leaves the vector stale. */
+	}
+	if (ix->items) ix->items[ix->count++]=item;
+
+	if (!ix->slots || !item->string) return;
+	if (2*(ix->used+1)>ix->mask+1) index_stale_keys(ix);	/* too full: rebuild larger on next lookup. */
+	else index_insert(ix,item);
+}
+
+/* Keep the index in step with the child at position which (or -1 if unknown) leaving container. */
+static void index_remove(cJSON *container,cJSON *item,int which)
+{
+	struct cJSON_Index *ix=container->index;cJSON **slot=index_slot_of(ix,item);
+	if (slot) *slot=&index_tombstone;
+	if (which<0 || !ix->items || (size_t)which>=ix->count) {index_stale_items(ix);return;}
+	memmove(ix->items+which,ix->items+which+1,(ix->count-which-1)*sizeof(cJSON*));
+	ix->count--;
+}
+
+static int expand(cJSON *item);	/* lazily parsed items get their children first, see below. */
+int cJSON_BuildIndex(cJSON *item)
+{
+	if (!item || (item->type&cJSON_IsReference) || !expand(item)) return 0;
+	if ((item->type&255)!=cJSON_Array && (item->type&255)!=cJSON_Object) return 0;
+	if (!index_build_items(item)) return 0;
+	return ((item->type&255)!=cJSON_Object) || index_build_keys(item);
+}
+
+void cJSON_DropIndex(cJSON *item)	{if (item && !(item->type&cJSON_IsReference)) {index_free(item->index);item->index=0;}}
+
+/* Take a copy of the allocator to use for one call: the given hooks with gaps filled by malloc/free, or the global hooks. */
+static void get_hooks(cJSON_Hooks *out,const cJSON_Hooks *hooks)
+{
+	if (!hooks) {out->malloc_fn=cJSON_malloc;out->free_fn=cJSON_free;return;}
+	out->malloc_fn=hooks->malloc_fn?hooks->malloc_fn:malloc;
+	out->free_fn=hooks->free_fn?hooks->free_fn:free;
+}
+
 /* Internal constructor. */
 static cJSON *cJSON_New_Item(void)
 {
@@ -89,64 +250,626 @@ static cJSON *cJSON_New_Item(void)
 	return node;
 }
 
-/* Delete a cJSON structure. */
-void cJSON_Delete(cJSON *c)
+/* Arena: nodes and strings are bump-allocated from a chain of chunks and released all at once. */
+typedef union {double d;void *p;long l;} arena_align;
+#define ARENA_ALIGN(n) (((n)+sizeof(arena_align)-1)/sizeof(arena_align)*sizeof(arena_align))
+typedef struct arena_chunk {struct arena_chunk *next; size_t size; size_t used;} arena_chunk;
+#define ARENA_HEADER ARENA_ALIGN(sizeof(arena_chunk))
+struct cJSON_Arena
+{
+	arena_chunk *head,*current;	/* every chunk ever allocated, and the one being filled. */
+	size_t chunk_size;
+	void *(*malloc_fn)(size_t sz);
+	void (*free_fn)(void *ptr);
+};
+
+cJSON_Arena *cJSON_CreateArena(size_t chunk_size,cJSON_Hooks *hooks)
+{
+	void *(*malloc_fn)(size_t sz)=(hooks && hooks->malloc_fn)?hooks->malloc_fn:malloc;
+	cJSON_Arena *arena=(cJSON_Arena*)malloc_fn(sizeof(cJSON_Arena));
+	if (!arena) return 0;
+	memset(arena,0,sizeof(cJSON_Arena));
+	arena->chunk_size=chunk_size?chunk_size:4096;
+	arena->malloc_fn=malloc_fn;
+	arena->free_fn=(hooks && hooks->free_fn)?hooks->free_fn:free;
+	return arena;
+}
+
+/* Forget everything allocated so far, keeping the chunks for the next document. */
+void cJSON_ResetArena(cJSON_Arena *arena)
+{
+	arena_chunk *c;
+	if (!arena) return;
+	for (c=arena->head;c;c=c->next) c->used=0;
+	arena->current=arena->head;
+}
+
+void cJSON_DeleteArena(cJSON_Arena *arena)
+{
+	arena_chunk *c,*next;
+	if (!arena) return;
+	for (c=arena->head;c;c=next) {next=c->next;arena->free_fn(c);}
+	arena->free_fn(arena);
+}
+
+static void *arena_alloc(cJSON_Arena *arena,size_t size)
+{
+	arena_chunk *c=arena->current;size_t chunk;
+	size=ARENA_ALIGN(size);
+	if (size<sizeof(arena_align)) size=sizeof(arena_align);
+	/* Try the rest of the chunks kept by a reset before allocating a new one. */
+	while (c && c->size-c->used<size) c=c->next;
+	if (!c)
+	{
+		chunk=(size>arena->chunk_size)?size:arena->chunk_size;
+		if (chunk>((size_t)-1)-ARENA_HEADER) return 0;
+		if (!(c=(arena_chunk*)arena->malloc_fn(ARENA_HEADER+chunk))) return 0;
+		c->size=chunk;c->used=0;
+		if (arena->current) {c->next=arena->current->next;arena->current->next=c;}
+		else {c->next=arena->head;arena->head=c;}
+	}
+	arena->current=c;
+	c->used+=size;
+	return (char*)c+ARENA_HEADER+c->used-size;
+}
+
+/* Give back everything allocated since chunk was current with used bytes filled. Chunks past current are always empty. */
+static void arena_rewind(cJSON_Arena *arena,arena_chunk *chunk,size_t used)
+{
+	arena_chunk *c;
+	if (!chunk) {cJSON_ResetArena(arena);return;}	/* the arena was empty. */
+	for (c=chunk->next;c;c=c->next) c->used=0;
+	chunk->used=used;arena->current=chunk;
+}
+
+/* Count an allocation in a parse or print's cJSON_Stats, if it keeps them. */
+static void stats_alloc(cJSON_Stats *stats,size_t size)	{if (stats) {stats->allocs++;stats->alloc_bytes+=size;}}
+
+/* Key tables: each distinct key is stored once, in an arena, and found again by hash with linear probing. */
+typedef struct {unsigned hash; size_t len; const PFCHAR *str;} key_slot;
+struct cJSON_KeyTable {key_slot *slots; size_t mask,count; cJSON_Arena *strings; cJSON_Hooks hooks;};
+
+cJSON_KeyTable *cJSON_CreateKeyTable(cJSON_Hooks *hooks)
+{
+	cJSON_Hooks h;cJSON_KeyTable *t;
+	get_hooks(&h,hooks);
+	if (!(t=(cJSON_KeyTable*)h.malloc_fn(sizeof(cJSON_KeyTable)))) return 0;
+	memset(t,0,sizeof(cJSON_KeyTable));
+	t->hooks=h;t->mask=63;
+	t->slots=(key_slot*)h.malloc_fn((t->mask+1)*sizeof(key_slot));
+	t->strings=cJSON_CreateArena(0,&t->hooks);
+	if (!t->slots || !t->strings) {cJSON_DeleteKeyTable(t);return 0;}
+	memset(t->slots,0,(t->mask+1)*sizeof(key_slot));
+	return t;
+}
+void cJSON_DeleteKeyTable(cJSON_KeyTable *t)
+{
+	if (!t) return;
+	if (t->slots) t->hooks.free_fn(t->slots);
+	cJSON_DeleteArena(t->strings);
+	t->hooks.free_fn(t);
+}
+
+static unsigned key_hash(const PFCHAR *key,size_t len)	{unsigned h=2166136261u;while (len--) h=(h^(UPFCHAR)*key++)*16777619u;return h;}	/* FNV-1a */
+
+/* The table's copy of len PFCHARs of key, added if it is new. A parse passes its stats, so growing the table and
+copying a new key count as its allocations. */
+static const PFCHAR *intern(cJSON_KeyTable *t,const PFCHAR *key,size_t len,cJSON_Stats *stats)
+{
+	unsigned h=key_hash(key,len);size_t i;key_slot *s;PFCHAR *copy;
+	if (2*(t->count+1)>t->mask+1)	/* keep it at most half full. */
+	{
+		size_t size=2*(t->mask+1),j;key_slot *grown=(key_slot*)t->hooks.malloc_fn(size*sizeof(key_slot));
+		if (!grown) return 0;
+		stats_alloc(stats,size*sizeof(key_slot));
+		memset(grown,0,size*sizeof(key_slot));
+		for (j=0;j<=t->mask;j++) if (t->slots[j].str)
+		{
+			for (i=t->slots[j].hash&(size-1);grown[i].str;i=(i+1)&(size-1));
+			grown[i]=t->slots[j];
+		}
+		t->hooks.free_fn(t->slots);t->slots=grown;t->mask=size-1;
+	}
+	for (i=h&t->mask;(s=&t->slots[i])->str;i=(i+1)&t->mask)
+		if (s->hash==h && s->len==len && !memcmp(s->str,key,len*sizeof(PFCHAR))) return s->str;
+	if (!(copy=(PFCHAR*)arena_alloc(t->strings,(len+1)*sizeof(PFCHAR)))) return 0;
+	stats_alloc(stats,(len+1)*sizeof(PFCHAR));
+	memcpy(copy,key,len*sizeof(PFCHAR));copy[len]=0;
+	s->hash=h;s->len=len;s->str=copy;t->count++;
+	return copy;
+}
+const PFCHAR *cJSON_InternKey(cJSON_KeyTable *t,const PFCHAR *key)	{return (t && key)?intern(t,key,strlen(key),0):0;}
+size_t cJSON_GetKeyTableSize(cJSON_KeyTable *t)						{return t?t->count:0;}
+
+/* State threaded through the parse routines. Nothing here is shared between parses. */
+typedef struct {
+	cJSON_Hooks hooks; cJSON_Arena *arena; const PFCHAR *ep;
+	cJSON_KeyTable *keys;	/* intern object keys here. */
+	const PFCHAR *end;	/* one past the input. */
+	int insitu;			/* unescape strings over the input. */
+	int lazy;			/* record arrays and objects as spans, see parse_lazy. */
+	int max_depth,depth;	/* nesting allowed, and reached by the recursive compact and tape builders. */
+	cJSON_Stats *stats;	/* if set, count what the parse costs here. */
+	int timed;			/* and time strings and numbers. */
+	const cJSON_Projection *projection;	/* if set, build only the members it names, see project_value. */
+	char point;			/* the locale's decimal point, once a number has needed strtod. */
+} parse_state;
+static void parse_init(parse_state *ps,const cJSON_Hooks *hooks)	{memset(ps,0,sizeof(parse_state));get_hooks(&ps->hooks,hooks);ps->max_depth=CJSON_NESTING_LIMIT;}
+
+/* Microseconds on a monotonic clock, for cJSON_Stats. */
+static double stats_clock(void)
+{
+#ifdef _WIN32
+	LARGE_INTEGER f,c;QueryPerformanceFrequency(&f);QueryPerformanceCounter(&c);
+	return (double)c.QuadPart*1e6/(double)f.QuadPart;
+#elif defined(CLOCK_MONOTONIC)
+	struct timespec t;clock_gettime(CLOCK_MONOTONIC,&t);
+	return t.tv_sec*1e6+t.tv_nsec/1e3;
+#else
+	return clock()*1e6/CLOCKS_PER_SEC;
+#endif
+}
+static void stats_depth(cJSON_Stats *stats,int depth)	{if (stats && depth>stats->max_depth) stats->max_depth=depth;}
+
+/* Parser allocations come from the arena when there is one, and the hooks otherwise. */
+static void *parse_alloc(size_t size,parse_state *ps)
+{
+	stats_alloc(ps->stats,size);
+	return ps->arena?arena_alloc(ps->arena,size):ps->hooks.malloc_fn(size);
+}
+static cJSON *parse_new_item(parse_state *ps)
+{
+	cJSON* node = (cJSON*)parse_alloc(sizeof(cJSON),ps);
+	if (node) memset(node,0,sizeof(cJSON));
+	if (ps->stats) ps->stats->nodes++;
+	return node;
+}
+
+/* Output buffer shared by the print routines; everything is appended at offset. With a sink, a full buffer is
+written out and refilled rather than grown, so it only grows to fit a single string longer than itself. */
+typedef struct {PFCHAR *buffer; size_t length; size_t offset; int noalloc; cJSON_Hooks hooks; cJSON_WriteCallback sink; void *user;
+	void *(*realloc_fn)(void *ptr,size_t sz); cJSON_Stats *stats;} printbuffer;
+#define PRINT_SINK_BUFFER 65536	/* default sink buffer, in PFCHARs. */
+
+/* Make room for needed more PFCHARs (plus a terminator) at the write position, growing geometrically. */
+static PFCHAR *ensure(printbuffer *p,size_t needed)
+{
+	PFCHAR *newbuffer;size_t newsize;
+	if (!p || !p->buffer) return 0;
+	needed+=p->offset+1;
+	if (needed<=p->length) return p->buffer+p->offset;
+	if (p->sink && p->offset)	/* pass on what is there and start over. */
+	{
+		if (!p->sink(p->user,p->buffer,p->offset)) return 0;
+		needed-=p->offset;p->offset=0;
+		if (needed<=p->length) return p->buffer;
+	}
+	if (p->noalloc) return 0;	/* caller supplied the buffer and it is full. */
+
+	newsize=p->length?p->length:64;
+	while (newsize<needed)
+	{
+		if (newsize>((size_t)-1)/(2*sizeof(PFCHAR))) return 0;	/* overflow. */
+		newsize*=2;
+	}
+	if (p->realloc_fn)
+	{
+		if (!(newbuffer=(PFCHAR*)p->realloc_fn(p->buffer,newsize*sizeof(PFCHAR)))) return 0;	/* the old buffer is still the caller's to free. */
+	}
+	else
+	{
+		newbuffer=(PFCHAR*)p->hooks.malloc_fn(newsize*sizeof(PFCHAR));
+		if (!newbuffer) return 0;
+		memcpy(newbuffer,p->buffer,p->offset*sizeof(PFCHAR));
+		p->hooks.free_fn(p->buffer);
+		if (p->stats) p->stats->allocs++;
+	}
+	if (p->stats) {p->stats->reallocs++;p->stats->alloc_bytes+=newsize*sizeof(PFCHAR);}
+	p->buffer=newbuffer;p->length=newsize;
+	return newbuffer+p->offset;
+}
+
+/* Append a literal of known length. */
+static int print_raw(printbuffer *p,const PFCHAR *str,size_t len)
+{
+	PFCHAR *out=ensure(p,len);
+	if (!out) return 0;
+	memcpy(out,str,len*sizeof(PFCHAR));
+	p->offset+=len;
+	return 1;
+}
+
+/* Append count tabs, for formatted output. */
+static int print_tabs(printbuffer *p,int count)
+{
+	PFCHAR *out;
+	if (count<=0) return 1;
+	if (!(out=ensure(p,count))) return 0;
+	p->offset+=count;
+	while (count--) *out++=_T('\t');
+	return 1;
+}
+
+/* Delete a cJSON structure. Indexes always come from the global hooks. Children are deleted before the item's
+siblings, which wait on a stack that grows from hooks; if it can't grow, the children are spliced in ahead of the
+siblings instead, so any depth is deleted in constant C stack space either way. */
+#define DELETE_STACK 32
+static void delete_item(cJSON *c,const cJSON_Hooks *hooks)
 {
-	cJSON *next;
+	cJSON *local[DELETE_STACK],**stack=local,**grown,*next,*last;int top=0,size=DELETE_STACK;
 	while (c)
 	{
 		next=c->next;
-		if (!(c->type&cJSON_IsReference) && c->child) cJSON_Delete(c->child);
-		if (!(c->type&cJSON_IsReference) && c->valuestring) cJSON_free(c->valuestring);
-		if (c->string) cJSON_free(c->string);
-		cJSON_free(c);
-		c=next;
+		if (!(c->type&cJSON_IsReference) && c->child)
+		{
+			if (next && top==size && (grown=(cJSON**)hooks->malloc_fn(2*size*sizeof(cJSON*))))
+			{
+				memcpy(grown,stack,size*sizeof(cJSON*));
+				if (stack!=local) hooks->free_fn(stack);
+				stack=grown;size*=2;
+			}
+			if (next && top<size) stack[top++]=next;
+			else if (next)	/* out of memory: walk to the last child and hang the siblings off it. */
+			{
+				last=c->child;
+				if (last->prev) last=last->prev;	/* the head points at the tail, as for cJSON_AddItemToArray. */
+				while (last->next) last=last->next;
+				last->next=next;
+			}
+			next=c->child;
+		}
+		if (!(c->type&(cJSON_IsReference|cJSON_IsLazy)) && c->valuestring) hooks->free_fn(c->valuestring);
+		if (!(c->type&cJSON_IsReference)) index_free(c->index);
+		if (c->string && !(c->type&cJSON_StringIsConst)) hooks->free_fn(c->string);
+		hooks->free_fn(c);
+		c=(next || !top)?next:stack[--top];
+	}
+	if (stack!=local) hooks->free_fn(stack);
+}
+void cJSON_Delete(cJSON *c)	{cJSON_Hooks hooks;get_hooks(&hooks,0);delete_item(c,&hooks);}
+
+/* Powers of ten that a double holds exactly; a product or quotient with them is correctly rounded. */
+static const double exact_pow10[]={1e0,1e1,1e2,1e3,1e4,1e5,1e6,1e7,1e8,1e9,1e10,1e11,1e12,1e13,1e14,1e15,1e16,1e17,1e18,1e19,1e20,1e21,1e22};
+
+/* Clamp a double into valueint, since out of range casts are undefined. */
+static int double_to_int(double d)	{return (d>=INT_MAX)?INT_MAX:(d<=(double)INT_MIN)?INT_MIN:(int)d;}
+
+/* The number conversions below need a 64-bit integer, which C89 doesn't name: unsigned long where it is that wide, and the
+compiler's own type otherwise. Constants are put together from 32-bit halves. */
+#if ULONG_MAX>>31>>31>=3
+typedef unsigned long num_u64;
+#elif defined(_MSC_VER)
+typedef unsigned __int64 num_u64;
+#else
+__extension__ typedef unsigned long long num_u64;
+#endif
+#define U64(hi,lo) (((num_u64)(hi)<<32)|(num_u64)(lo))
+
+/* f*2^e with a 64-bit significand, after Loitsch, "Printing Floating-Point Numbers Quickly and Accurately with Integers". */
+typedef struct {num_u64 f;int e;} diy_fp;
+
+/* The top half of the 128-bit product, rounded, so within half a unit of the exact product. */
+static diy_fp diy_mul(diy_fp x,diy_fp y)
+{
+	num_u64 a=x.f>>32,b=x.f&0xffffffffUL,c=y.f>>32,d=y.f&0xffffffffUL;
+	num_u64 ac=a*c,bc=b*c,ad=a*d,bd=b*d,mid=(bd>>32)+(ad&0xffffffffUL)+(bc&0xffffffffUL)+0x80000000UL;
+	diy_fp r;r.f=ac+(ad>>32)+(bc>>32)+(mid>>32);r.e=x.e+y.e+64;
+	return r;
+}
+/* Shift a nonzero x up until its top bit is set. */
+static diy_fp diy_normalize(diy_fp x)
+{
+#ifdef __GNUC__
+	int s=__builtin_clzll(x.f);x.f<<=s;x.e-=s;
+#else
+	int s;for (s=32;s;s>>=1) if (!(x.f>>(64-s))) x.f<<=s,x.e-=s;
+#endif
+	return x;
+}
+
+/* 10^k for k=-348,-340..340 as normalized f*2^e, f rounded to nearest: {f high,f low,e,k}. */
+static const struct {unsigned long hi,lo;short e,k;} cached_pow10[]={
+	{0xfa8fd5a0UL,0x081c0288UL,-1220,-348},{0xbaaee17fUL,0xa23ebf76UL,-1193,-340},{0x8b16fb20UL,0x3055ac76UL,-1166,-332},{0xcf42894aUL,0x5dce35eaUL,-1140,-324},
+	{0x9a6bb0aaUL,0x55653b2dUL,-1113,-316},{0xe61acf03UL,0x3d1a45dfUL,-1087,-308},{0xab70fe17UL,0xc79ac6caUL,-1060,-300},{0xff77b1fcUL,0xbebcdc4fUL,-1034,-292},
+	{0xbe5691efUL,0x416bd60cUL,-1007,-284},{0x8dd01fadUL,0x907ffc3cUL,-980,-276},{0xd3515c28UL,0x31559a83UL,-954,-268},{0x9d71ac8fUL,0xada6c9b5UL,-927,-260},
+	{0xea9c2277UL,0x23ee8bcbUL,-901,-252},{0xaecc4991UL,0x4078536dUL,-874,-244},{0x823c1279UL,0x5db6ce57UL,-847,-236},{0xc2109436UL,0x4dfb5637UL,-821,-228},
+	{0x9096ea6fUL,0x3848984fUL,-794,-220},{0xd77485cbUL,0x25823ac7UL,-768,-212},{0xa086cfcdUL,0x97bf97f4UL,-741,-204},{0xef340a98UL,0x172aace5UL,-715,-196},
+	{0xb23867fbUL,0x2a35b28eUL,-688,-188},{0x84c8d4dfUL,0xd2c63f3bUL,-661,-180},{0xc5dd4427UL,0x1ad3cdbaUL,-635,-172},{0x936b9fceUL,0xbb25c996UL,-608,-164},
+	{0xdbac6c24UL,0x7d62a584UL,-582,-156},{0xa3ab6658UL,0x0d5fdaf6UL,-555,-148},{0xf3e2f893UL,0xdec3f126UL,-529,-140},{0xb5b5ada8UL,0xaaff80b8UL,-502,-132},
+	{0x87625f05UL,0x6c7c4a8bUL,-475,-124},{0xc9bcff60UL,0x34c13053UL,-449,-116},{0x964e858cUL,0x91ba2655UL,-422,-108},{0xdff97724UL,0x70297ebdUL,-396,-100},
+	{0xa6dfbd9fUL,0xb8e5b88fUL,-369,-92},{0xf8a95fcfUL,0x88747d94UL,-343,-84},{0xb9447093UL,0x8fa89bcfUL,-316,-76},{0x8a08f0f8UL,0xbf0f156bUL,-289,-68},
+	{0xcdb02555UL,0x653131b6UL,-263,-60},{0x993fe2c6UL,0xd07b7facUL,-236,-52},{0xe45c10c4UL,0x2a2b3b06UL,-210,-44},{0xaa242499UL,0x697392d3UL,-183,-36},
+	{0xfd87b5f2UL,0x8300ca0eUL,-157,-28},{0xbce50864UL,0x92111aebUL,-130,-20},{0x8cbccc09UL,0x6f5088ccUL,-103,-12},{0xd1b71758UL,0xe219652cUL,-77,-4},
+	{0x9c400000UL,0x00000000UL,-50,4},{0xe8d4a510UL,0x00000000UL,-24,12},{0xad78ebc5UL,0xac620000UL,3,20},{0x813f3978UL,0xf8940984UL,30,28},
+	{0xc097ce7bUL,0xc90715b3UL,56,36},{0x8f7e32ceUL,0x7bea5c70UL,83,44},{0xd5d238a4UL,0xabe98068UL,109,52},{0x9f4f2726UL,0x179a2245UL,136,60},
+	{0xed63a231UL,0xd4c4fb27UL,162,68},{0xb0de6538UL,0x8cc8ada8UL,189,76},{0x83c7088eUL,0x1aab65dbUL,216,84},{0xc45d1df9UL,0x42711d9aUL,242,92},
+	{0x924d692cUL,0xa61be758UL,269,100},{0xda01ee64UL,0x1a708deaUL,295,108},{0xa26da399UL,0x9aef774aUL,322,116},{0xf209787bUL,0xb47d6b85UL,348,124},
+	{0xb454e4a1UL,0x79dd1877UL,375,132},{0x865b8692UL,0x5b9bc5c2UL,402,140},{0xc83553c5UL,0xc8965d3dUL,428,148},{0x952ab45cUL,0xfa97a0b3UL,455,156},
+	{0xde469fbdUL,0x99a05fe3UL,481,164},{0xa59bc234UL,0xdb398c25UL,508,172},{0xf6c69a72UL,0xa3989f5cUL,534,180},{0xb7dcbf53UL,0x54e9beceUL,561,188},
+	{0x88fcf317UL,0xf22241e2UL,588,196},{0xcc20ce9bUL,0xd35c78a5UL,614,204},{0x98165af3UL,0x7b2153dfUL,641,212},{0xe2a0b5dcUL,0x971f303aUL,667,220},
+	{0xa8d9d153UL,0x5ce3b396UL,694,228},{0xfb9b7cd9UL,0xa4a7443cUL,720,236},{0xbb764c4cUL,0xa7a44410UL,747,244},{0x8bab8eefUL,0xb6409c1aUL,774,252},
+	{0xd01fef10UL,0xa657842cUL,800,260},{0x9b10a4e5UL,0xe9913129UL,827,268},{0xe7109bfbUL,0xa19c0c9dUL,853,276},{0xac2820d9UL,0x623bf429UL,880,284},
+	{0x80444b5eUL,0x7aa7cf85UL,907,292},{0xbf21e440UL,0x03acdd2dUL,933,300},{0x8e679c2fUL,0x5e44ff8fUL,960,308},{0xd433179dUL,0x9c8cb841UL,986,316},
+	{0x9e19db92UL,0xb4e31ba9UL,1013,324},{0xeb96bf6eUL,0xbadf77d9UL,1039,332},{0xaf87023bUL,0x9bf0ee6bUL,1066,340}
+};
+static diy_fp cached_power(int i,int *k)	{diy_fp r;r.f=U64(cached_pow10[i].hi,cached_pow10[i].lo);r.e=cached_pow10[i].e;*k=cached_pow10[i].k;return r;}
+
+/* m*10^e10 as a double in one diy_fp multiply, where m is the literal's first 19 digits and inexact says digits were
+dropped after them. The error is kept in eighths of a unit; if it leaves the rounding in doubt this returns 0 and the
+caller asks strtod. This is double-conversion's DiyFpStrtod. Needs m>0 and -348<=e10<=340. */
+static int diy_to_double(num_u64 m,int inexact,int e10,double *out)
+{
+	diy_fp x,p;int k,e,size,lost;num_u64 error=inexact?8:0,half,low,r;
+
+	p=cached_power((e10+348)/8,&k);
+	x.f=m;x.e=0;
+	if (k<e10)	/* the cached powers are 8 apart: make up the rest with an exact one, in integers if it fits. */
+	{
+		num_u64 scale=(num_u64)exact_pow10[e10-k];
+		if (m<=(~(num_u64)0)/scale) x.f=m*scale,error*=scale;
+		else
+		{
+			diy_fp a;a.f=scale;a.e=0;
+			x=diy_normalize(x);error<<=-x.e;
+			x=diy_mul(x,diy_normalize(a));error+=4;
+		}
+	}
+	e=x.e;x=diy_normalize(x);error<<=e-x.e;
+	x=diy_mul(x,p);error+=4+(error?1:0)+4;	/* the cached power's half unit, their product's, and the rounding's. */
+	e=x.e;x=diy_normalize(x);error<<=e-x.e;
+
+	/* Round off the bits below the double's precision, which is less for subnormals. */
+	size=(64+x.e>=-1074+53)?53:(64+x.e<=-1074)?0:64+x.e+1074;
+	lost=64-size;
+	if (lost+3>=64)	/* too few bits left for eighths: shift everything down. */
+	{
+		int s=lost+3-64+1;
+		x.f>>=s;x.e+=s;error=(error>>s)+1+8;lost-=s;
 	}
+	low=(x.f&(((num_u64)1<<lost)-1))*8;half=((num_u64)1<<(lost-1))*8;
+	r=x.f>>lost;
+	if (low>=half+error) r++;
+	if (half-error<low && low<half+error) return 0;
+	*out=ldexp((double)r,x.e+lost);
+	return 1;
+}
+
+/* Correctly rounded conversion of a JSON number literal: strtod on a copy of it, with '.' swapped for the locale's decimal
+point, which is looked up once per parse. Returns 0 on memory failure. */
+static int text_to_double(const PFCHAR *start,const PFCHAR *end,double *out,const cJSON_Hooks *hooks,char *point)
+{
+	char local[64],*buf=local;size_t i,len=end-start;
+	if (!*point) *point=localeconv()->decimal_point[0];
+	if (len>=sizeof(local) && !(buf=(char*)hooks->malloc_fn(len+1))) return 0;
+	for (i=0;i<len;i++) buf[i]=(start[i]==_T('.'))?*point:(char)start[i];
+	buf[len]=0;
+	*out=strtod(buf,0);
+	if (buf!=local) hooks->free_fn(buf);
+	return 1;
 }
 
-/* Parse the input text to generate a number, and populate the result into item. */
-static const PFCHAR *parse_number(cJSON *item,const PFCHAR *num)
+/* Parse the input text to generate a number, and populate the result into item.
+The first 19 significant digits accumulate exactly in 64 bits. Up to 2^53 with an exponent within 22, one multiply or
+divide by an exact power of ten gives the correctly rounded result (Clinger's fast path); most of the rest take one
+diy_fp multiply, and strtod sees only what that can't round for certain, or what overflows or underflows. */
+static const PFCHAR *parse_number(cJSON *item,const PFCHAR *num,parse_state *ps)
 {
-	double n=0,sign=1,scale=0;int subscale=0,signsubscale=1;
+	const PFCHAR *start=num,*end=ps->end;num_u64 m=0;double n;int sign=1,digits=0,inexact=0,scale=0,subscale=0,signsubscale=1;
 
-	if (*num==_T('-')) sign=-1,num++;	/* Has sign? */
-	if (*num==_T('0')) num++;			/* is zero */
-	if (*num>=_T('1') && *num<=_T('9'))	do	n=(n*10.0)+(*num++ -_T('0'));	while (*num>=_T('0') && *num<=_T('9'));	/* Number? */
-	if (*num==_T('.') && num[1]>=_T('0') && num[1]<=_T('9')) {num++;		do	n=(n*10.0)+(*num++ -_T('0')),scale--; while (*num>=_T('0') && *num<=_T('9'));}	/* Fractional part? */
-	if (*num==_T('e') || *num==_T('E'))		/* Exponent? */
-	{	num++;if (*num==_T('+')) num++;	else if (*num==_T('-')) signsubscale=-1,num++;		/* With sign? */
-		while (*num>=_T('0') && *num<=_T('9')) subscale=(subscale*10)+(*num++ - _T('0'));	/* Number? */
+	if (num<end && *num==_T('-')) sign=-1,num++;	/* Has sign? */
+	if (num<end && *num==_T('0')) num++;			/* is zero */
+	if (num<end && *num>=_T('1') && *num<=_T('9'))	/* Number? */
+	{
+		do	m=m*10+(*num++ -_T('0')),digits++;	while (digits<19 && num<end && *num>=_T('0') && *num<=_T('9'));
+		while (num<end && *num>=_T('0') && *num<=_T('9')) scale++,inexact|=(*num++!=_T('0'));
+	}
+	if (end-num>1 && *num==_T('.') && num[1]>=_T('0') && num[1]<=_T('9'))	/* Fractional part? */
+	{
+		num++;
+		if (!m) while (num<end && *num==_T('0')) num++,scale--;
+		while (digits<19 && num<end && *num>=_T('0') && *num<=_T('9')) m=m*10+(*num++ -_T('0')),digits++,scale--;
+		while (num<end && *num>=_T('0') && *num<=_T('9')) inexact|=(*num++!=_T('0'));
+	}
+	if (num<end && (*num==_T('e') || *num==_T('E')))		/* Exponent? */
+	{	num++;if (num<end && *num==_T('+')) num++;	else if (num<end && *num==_T('-')) signsubscale=-1,num++;		/* With sign? */
+		while (num<end && *num>=_T('0') && *num<=_T('9')) {if (subscale<100000) subscale=(subscale*10)+(*num-_T('0'));num++;}	/* Number? */
 	}
 
-	n=sign*n*pow(10.0,(scale+subscale*signsubscale));	/* number = +/- number.fraction * 10^+/- exponent */
+	scale+=subscale*signsubscale;
+	/* number = +/- m * 10^+/- scale */
+	if (!m)																		n=0;
+	else if (!inexact && m<=(num_u64)1<<53 && scale>=0 && scale<=22)			n=(double)m*exact_pow10[scale];
+	else if (!inexact && m<=(num_u64)1<<53 && scale<0 && scale>=-22)			n=(double)m/exact_pow10[-scale];
+	else if (digits+scale>-326 && digits+scale<=309 && diy_to_double(m,inexact,scale,&n)) ;
+	else if (!text_to_double(start,num,&n,&ps->hooks,&ps->point))			return 0;	/* memory fail. */
+	else sign=1;	/* strtod read the sign itself. */
 	
-	item->valuedouble=n;
-	item->valueint=(int)n;
+	item->valuedouble=sign*n;
+	item->valueint=double_to_int(item->valuedouble);
 	item->type=cJSON_Number;
 	return num;
 }
 
-/* Render the number nicely from the given item into a string. */
-static PFCHAR *print_number(cJSON *item)
+/* Grisu3's last step: move the last digit towards w while that stays inside the interval, and fail if another candidate
+might be closer or the digits might lie outside, each within the unit of error. The weeding is double-conversion's. */
+static int round_weed(char *digits,int n,num_u64 high_w,num_u64 unsafe,num_u64 rest,num_u64 ten_kappa,num_u64 unit)
 {
-	PFCHAR *str;
-	double d=item->valuedouble;
-	if (fabs(((double)item->valueint)-d)<=DBL_EPSILON && d<=INT_MAX && d>=INT_MIN)
+	num_u64 small=high_w-unit,big=high_w+unit;
+	while (rest<small && unsafe-rest>=ten_kappa && (rest+ten_kappa<small || small-rest>=rest+ten_kappa-small))
+		digits[n-1]--,rest+=ten_kappa;
+	if (rest<big && unsafe-rest>=ten_kappa && (rest+ten_kappa<big || big-rest>rest+ten_kappa-big)) return 0;
+	return 2*unit<=rest && rest<=unsafe-4*unit;
+}
+
+/* The shortest digits that read back as positive finite d, and of those the closest, by Grisu3: d is digits*10^k.
+Returns how many digits, or 0 for the one double in a few hundred where it can't prove its answer. */
+static int grisu3(double d,char *digits,int *k)
+{
+	diy_fp w,plus,minus,c;int ex,mk,i,kappa,n=0,shift;unsigned long integrals,divisor;num_u64 one,fractionals,unsafe,rest,unit=1;
+
+	w.f=(num_u64)ldexp(frexp(d,&ex),53);w.e=ex-53;
+	if (w.e<-1074) w.f>>=-1074-w.e,w.e=-1074;	/* subnormal: the last place is 2^-1074. */
+	/* The halfway points to the neighbouring doubles, on a common exponent. Below a power of two the gap is half as wide. */
+	plus.f=(w.f<<1)+1;plus.e=w.e-1;plus=diy_normalize(plus);
+	if (w.f==(num_u64)1<<52 && w.e>-1074)	minus.f=(w.f<<2)-1,minus.e=w.e-2;
+	else									minus.f=(w.f<<1)-1,minus.e=w.e-1;
+	minus.f<<=minus.e-plus.e;minus.e=plus.e;
+	w=diy_normalize(w);
+
+	/* Scale by a cached 10^mk that brings the binary exponent into [-60,-32], so the integral part fits 32 bits. */
+	i=(348+(int)ceil((-60-(w.e+64)+63)*0.30102999566398114)-1)/8+1;
+	c=cached_power(i,&mk);
+	w=diy_mul(w,c);plus=diy_mul(plus,c);minus=diy_mul(minus,c);
+
+	/* Digits of the upper bound, widened by a unit of error either way, until they fall inside the interval. */
+	plus.f++;minus.f--;unsafe=plus.f-minus.f;
+	shift=-w.e;one=(num_u64)1<<shift;
+	integrals=(unsigned long)(plus.f>>shift);fractionals=plus.f&(one-1);
+	for (divisor=1000000000UL,kappa=10;divisor>integrals;divisor/=10) kappa--;
+	while (kappa>0)
 	{
-		str=(PFCHAR*)cJSON_malloc(21*sizeof(PFCHAR));	/* 2^64+1 can be represented in 21 PFCHARs. */
-		if (str) sprintf(str,_T("%d"),item->valueint);
+		digits[n++]=(char)('0'+integrals/divisor);integrals%=divisor;kappa--;
+		rest=((num_u64)integrals<<shift)+fractionals;
+		if (rest<unsafe)
+		{
+			*k=kappa-mk;
+			return round_weed(digits,n,plus.f-w.f,unsafe,rest,(num_u64)divisor<<shift,unit)?n:0;
+		}
+		divisor/=10;
 	}
-	else
+	for (;;)
 	{
-		str=(PFCHAR*)cJSON_malloc(64*sizeof(PFCHAR));	/* This is a nice tradeoff. */
-		if (str)
+		fractionals*=10;unit*=10;unsafe*=10;
+		digits[n++]=(char)('0'+(int)(fractionals>>shift));fractionals&=one-1;kappa--;
+		if (fractionals<unsafe)
 		{
-			if (fabs(floor(d)-d)<=DBL_EPSILON && fabs(d)<1.0e60)sprintf(str,_T("%.0f"),d);
-			else if (fabs(d)<1.0e-6 || fabs(d)>1.0e9)			sprintf(str,_T("%e"),d);
-			else												sprintf(str,_T("%f"),d);
+			*k=kappa-mk;
+			return round_weed(digits,n,(plus.f-w.f)*unit,unsafe,fractionals,one,unit)?n:0;
 		}
 	}
-	return str;
+}
+
+/* Unsigned integers in 32-bit limbs, least significant first, with no zero limbs on top: wide enough for any double scaled
+by the power of ten nearest it, times ten. */
+typedef struct {unsigned long d[40];int n;} bignum;
+static void big_set(bignum *b,num_u64 v)	{b->n=0;while (v) b->d[b->n++]=(unsigned long)(v&0xffffffffUL),v>>=32;}
+static void big_mul(bignum *b,unsigned long m)
+{
+	num_u64 c=0;int i;
+	for (i=0;i<b->n;i++) {c+=(num_u64)b->d[i]*m;b->d[i]=(unsigned long)(c&0xffffffffUL);c>>=32;}
+	if (c) b->d[b->n++]=(unsigned long)c;
+}
+static void big_pow10(bignum *b,int k)	{for (;k>=9;k-=9) big_mul(b,1000000000UL);if (k) big_mul(b,(unsigned long)exact_pow10[k]);}
+static void big_shift(bignum *b,int s)
+{
+	int limbs=s/32,bits=s%32,i;unsigned long carry=0,x;
+	if (!b->n) return;
+	if (bits)
+	{
+		for (i=0;i<b->n;i++) {x=b->d[i];b->d[i]=((x<<bits)|carry)&0xffffffffUL;carry=x>>(32-bits);}
+		if (carry) b->d[b->n++]=carry;
+	}
+	if (limbs) {for (i=b->n-1;i>=0;i--) b->d[i+limbs]=b->d[i];for (i=0;i<limbs;i++) b->d[i]=0;b->n+=limbs;}
+}
+static int big_cmp(const bignum *a,const bignum *b)
+{
+	int i;
+	if (a->n!=b->n) return (a->n<b->n)?-1:1;
+	for (i=a->n-1;i>=0;i--) if (a->d[i]!=b->d[i]) return (a->d[i]<b->d[i])?-1:1;
+	return 0;
+}
+static void big_add(bignum *out,const bignum *a,const bignum *b)	/* out may be a, not b. */
+{
+	num_u64 c=0;int i,n=(a->n>b->n)?a->n:b->n;
+	for (i=0;i<n;i++) {c+=(num_u64)((i<a->n)?a->d[i]:0)+((i<b->n)?b->d[i]:0);out->d[i]=(unsigned long)(c&0xffffffffUL);c>>=32;}
+	out->n=n;if (c) out->d[out->n++]=(unsigned long)c;
+}
+static void big_sub(bignum *a,const bignum *b)	/* a>=b. */
+{
+	num_u64 borrow=0,x;int i;
+	for (i=0;i<a->n;i++)
+	{
+		x=(num_u64)a->d[i]-((i<b->n)?b->d[i]:0)-borrow;
+		borrow=(x>>63)&1;a->d[i]=(unsigned long)(x&0xffffffffUL);
+	}
+	while (a->n && !a->d[a->n-1]) a->n--;
+}
+
+/* What Grisu3 gives up on, exactly: Burger and Dybvig's free-format algorithm, "Printing Floating-Point Numbers Quickly
+and Accurately". d=r/s, with the halfway points to its neighbours at (r-mm)/s and (r+mp)/s; the digits come out one at a
+time until they are inside those bounds, which d's even significand makes inclusive, as strtod rounds to even. */
+static int dragon4(double d,char *digits,int *k)
+{
+	bignum r,s,mp,mm,t;int ex,e,n=0,even,low,high,kk;num_u64 f;
+	f=(num_u64)ldexp(frexp(d,&ex),53);e=ex-53;
+	if (e<-1074) f>>=-1074-e,e=-1074;
+	even=!(f&1);
+	big_set(&r,f);big_set(&s,1);big_set(&mp,1);big_set(&mm,1);
+	if (f==(num_u64)1<<52 && e>-1074)	{big_shift(&r,2);big_shift(&s,2);big_shift(&mp,1);}	/* the gap below is half as wide. */
+	else								{big_shift(&r,1);big_shift(&s,1);}
+	if (e>=0)	{big_shift(&r,e);big_shift(&mp,e);big_shift(&mm,e);}
+	else		big_shift(&s,-e);
+	kk=(int)ceil(log10(d)-1e-10);
+	if (kk>=0) big_pow10(&s,kk);
+	else {big_pow10(&r,-kk);big_pow10(&mp,-kk);big_pow10(&mm,-kk);}
+	big_add(&t,&r,&mp);
+	if (big_cmp(&t,&s)>=!even) kk++;	/* the estimate was one short. */
+	else {big_mul(&r,10);big_mul(&mp,10);big_mul(&mm,10);}
+	for (;;)
+	{
+		digits[n]='0';
+		while (big_cmp(&r,&s)>=0) big_sub(&r,&s),digits[n]++;
+		big_add(&t,&r,&mp);
+		low=(big_cmp(&r,&mm)<even);high=(big_cmp(&t,&s)>=!even);
+		n++;
+		if (low || high) break;
+		big_mul(&r,10);big_mul(&mp,10);big_mul(&mm,10);
+	}
+	if (low && high) {big_add(&t,&r,&r);e=big_cmp(&t,&s);high=(e>0 || (e==0 && (digits[n-1]&1)));}	/* nearer, ties to even. */
+	if (high) digits[n-1]++;
+	*k=kk-n;
+	return n;
+}
+
+/* Render the number from the given item into the print buffer, in the fewest digits that read back as the same double.
+Integers are written out whole; the rest are laid out as %g would, with as many digits as it takes. */
+static int print_number(cJSON *item,printbuffer *p)
+{
+	PFCHAR str[40],*ptr;char digits[24];double d=item->valuedouble,m=fabs(d);int n,k,x,i;num_u64 u;
+
+	if (d!=d || d-d!=0) return print_raw(p,_T("null"),4);	/* NaN and the infinities have no JSON spelling. */
+	if (d==floor(d) && m<=9007199254740992.0)
+	{
+		ptr=str+40;u=(num_u64)m;
+		do *--ptr=(PFCHAR)(_T('0')+(int)(u%10)); while (u/=10);
+		if (d<0) *--ptr=_T('-');
+		return print_raw(p,ptr,str+40-ptr);
+	}
+
+	if (!(n=grisu3(m,digits,&k))) n=dragon4(m,digits,&k);
+	while (n>1 && digits[n-1]=='0') n--,k++;
+	x=n+k-1;ptr=str;	/* the exponent of the first digit */
+	if (d<0) *ptr++=_T('-');
+	if (x<-4 || x>=n)
+	{
+		*ptr++=(PFCHAR)digits[0];
+		if (n>1) for (*ptr++=_T('.'),i=1;i<n;i++) *ptr++=(PFCHAR)digits[i];
+		*ptr++=_T('e');*ptr++=(x<0)?_T('-'):_T('+');x=(x<0)?-x:x;
+		if (x>=100) *ptr++=(PFCHAR)(_T('0')+x/100);
+		*ptr++=(PFCHAR)(_T('0')+x/10%10);*ptr++=(PFCHAR)(_T('0')+x%10);
+	}
+	else if (x<0)
+	{
+		*ptr++=_T('0');*ptr++=_T('.');
+		for (i=x;++i<0;) *ptr++=_T('0');
+		for (i=0;i<n;i++) *ptr++=(PFCHAR)digits[i];
+	}
+	else for (i=0;i<n;i++)
+	{
+		if (i==x+1) *ptr++=_T('.');
+		*ptr++=(PFCHAR)digits[i];
+	}
+	return print_raw(p,str,ptr-str);
 }
 
 static unsigned parse_hex4(const PFCHAR *str)
@@ -162,27 +885,87 @@ static unsigned parse_hex4(const PFCHAR *str)
 	return h;
 }
 
+/* Length of the run at str, stopping at end, free of the characters that end or escape a JSON string: '"', '\\' and
+controls (including the terminator). from is where the caller's text starts, at or before str. With SSE2 this goes
+16 at a time, and the last few PFCHARs come from the 16 before end if from reaches back that far. Nothing outside
+[from,end) is read. */
+#ifdef CJSON_SSE2
+static unsigned first_bit(unsigned mask)
+{
+#ifdef __GNUC__
+	return (unsigned)__builtin_ctz(mask);
+#else
+	unsigned n=0;while (!(mask&1)) mask>>=1,n++;return n;
+#endif
+}
+static unsigned clean_stops(const PFCHAR *block)
+{
+	__m128i v=_mm_loadu_si128((const __m128i*)block);
+	return _mm_movemask_epi8(_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v,_mm_set1_epi8('\"')),_mm_cmpeq_epi8(v,_mm_set1_epi8('\\'))),
+		_mm_cmpeq_epi8(_mm_min_epu8(v,_mm_set1_epi8(31)),v)));
+}
+#endif
+static size_t clean_run(const PFCHAR *str,const PFCHAR *end,const PFCHAR *from)
+{
+	const PFCHAR *ptr=str;
+#ifdef CJSON_SSE2
+	unsigned mask;
+	for (;end-ptr>=16;ptr+=16) if ((mask=clean_stops(ptr))) return (ptr-str)+first_bit(mask);
+	if (ptr<end && end-from>=16)	/* the 16 before end, with the lanes before ptr shifted out. */
+	{
+		mask=clean_stops(end-16)>>(16-(end-ptr));
+		return mask?(size_t)(ptr-str)+first_bit(mask):(size_t)(end-str);
+	}
+#endif
+	while (ptr<end && (UPFCHAR)*ptr>31 && *ptr!=_T('\"') && *ptr!=_T('\\')) ptr++;
+	return ptr-str;
+}
+
+/* Find the closing quote of the string whose text starts at ptr, skipping escaped quotes, or where it stops short. */
+static const PFCHAR *string_stop(const PFCHAR *ptr,const PFCHAR *end)
+{
+	const PFCHAR *from=ptr;
+	for (;;)
+	{
+		ptr+=clean_run(ptr,end,from);
+		if (ptr>=end) break;
+		if (*ptr==_T('\\') && end-ptr>1 && ptr[1]) ptr+=2;
+		else if ((UPFCHAR)*ptr<32 && *ptr) ptr++;
+		else break;
+	}
+	return ptr;
+}
+
 /* Parse the input text into an unescaped cstring, and populate item. */
 static const UPFCHAR firstByteMark[7] = { 0x00, 0x00, 0xC0, 0xE0, 0xF0, 0xF8, 0xFC };
-static const PFCHAR *parse_string(cJSON *item,const PFCHAR *str)
+static const PFCHAR *parse_string(cJSON *item,const PFCHAR *str,parse_state *ps)
 {
-	const PFCHAR *ptr=str+1;PFCHAR *ptr2;PFCHAR *out;int len=0;
+	const PFCHAR *ptr=str+1,*stop,*end=ps->end;PFCHAR *ptr2;PFCHAR *out;size_t len;
 #ifdef USE_UNICODE
 	PFCHAR uc,uc2;
 #else
 	unsigned uc,uc2;
 #endif
-	if (*str!=_T('\"')) {ep=str;return 0;}	/* not a string! */
+	if (str>=end || *str!=_T('\"')) {ps->ep=str;return 0;}	/* not a string! */
 	
-	while (*ptr!=_T('\"') && *ptr && ++len) if (*ptr++ == _T('\\')) ptr++;	/* Skip escaped quotes. */
+	/* Find the closing quote; unescaping only shrinks, so that bounds the length. */
+	stop=string_stop(ptr,end);len=stop-str-1;
 	
-	out=(PFCHAR*)cJSON_malloc((len+1)*sizeof(PFCHAR));	/* This is how long we need for the string, roughly. */
+	if (!ps->insitu) out=(PFCHAR*)parse_alloc((len+1)*sizeof(PFCHAR),ps);
+	else if (stop<end) out=(PFCHAR*)str+1;	/* the caller's buffer: the terminator goes over the closing quote. */
+	else {ps->ep=stop;return 0;}	/* unterminated, with no room for a terminator. */
 	if (!out) return 0;
 	
 	ptr=str+1;ptr2=out;
-	while (*ptr!=_T('\"') && *ptr)
+	while (ptr<stop)
 	{
-		if (*ptr!=_T('\\')) *ptr2++=*ptr++;
+		if (*ptr!=_T('\\'))
+		{
+			size_t run=clean_run(ptr,stop,str);	/* copy the unescaped stretch in one go. */
+			if (!run) run=1;	/* a raw control character. */
+			if (ptr2!=ptr) memmove(ptr2,ptr,run*sizeof(PFCHAR));
+			ptr+=run;ptr2+=run;
+		}
 		else
 		{
 			ptr++;
@@ -194,6 +977,7 @@ static const PFCHAR *parse_string(cJSON *item,const PFCHAR *str)
 				case _T('r'): *ptr2++=_T('\r');	break;
 				case _T('t'): *ptr2++=_T('\t');	break;
 				case _T('u'):	 /* transcode utf16 to utf8. */
+					if (stop-ptr<5) {ptr=stop-1;break;}	/* truncated. */
 #ifdef USE_UNICODE
 					uc=parse_hex4(ptr+1);ptr+=4;
 					*ptr2++ = uc;
@@ -204,7 +988,7 @@ static const PFCHAR *parse_string(cJSON *item,const PFCHAR *str)
 
 					if (uc>=0xD800 && uc<=0xDBFF)	/* UTF16 surrogate pairs.	*/
 					{
-						if (ptr[1]!=_T('\\') || ptr[2]!=_T('u'))	break;	/* missing second-half of surrogate.	*/
+						if (stop-ptr<7 || ptr[1]!=_T('\\') || ptr[2]!=_T('u'))	break;	/* missing second-half of surrogate.	*/
 						uc2=parse_hex4(ptr+3);ptr+=6;
 						if (uc2<0xDC00 || uc2>0xDFFF)		break;	/* invalid second-half of surrogate.	*/
 						uc=0x10000 + (((uc&0x3FF)<<10) | (uc2&0x3FF));
@@ -235,29 +1019,46 @@ static const PFCHAR *parse_string(cJSON *item,const PFCHAR *str)
 			ptr++;
 		}
 	}
+	ptr=stop;
+	if (ptr<end && *ptr==_T('\"')) ptr++;
 	*ptr2=0;
-	if (*ptr==_T('\"')) ptr++;
+	if (ps->stats) ps->stats->string_bytes+=ptr2-out;
 	item->valuestring=out;
-	item->type=cJSON_String;
+	item->type=cJSON_String|(ps->insitu?cJSON_IsReference:0);	/* in-situ strings belong to the input. */
 	return ptr;
 }
 
-/* Render the cstring provided to an escaped version that can be printed. */
-static PFCHAR *print_string_ptr(const PFCHAR *str)
+/* Render the cstring provided to an escaped version and append it to the print buffer. */
+static int print_string_ptr(const PFCHAR *str,printbuffer *p)
 {
-	const PFCHAR *ptr;PFCHAR *ptr2,*out;int len=0;UPFCHAR token;
+	const PFCHAR *ptr,*end;PFCHAR *ptr2,*out;size_t len=0,run,n;UPFCHAR token;
 	
-	if (!str) return cJSON_strdup(_T(""));
-	ptr=str;while ((token=*ptr) && ++len) {if (strchr(_T("\"\\\b\f\n\r\t"),token)) len++; else if (token<32) len+=5;ptr++;}
+	if (!str) str=_T("");
+	/* Most names and values are short and need no escapes: one look at each PFCHAR settles those. */
+	for (n=0;n<16 && (UPFCHAR)str[n]>31 && str[n]!=_T('\"') && str[n]!=_T('\\');n++);
+	if (!str[n])
+	{
+		if (!(out=ensure(p,n+2))) return 0;
+		out[0]=_T('\"');memcpy(out+1,str,n*sizeof(PFCHAR));out[n+1]=_T('\"');
+		p->offset+=n+2;
+		return 1;
+	}
+	end=str+n+strlen(str+n);
+	/* Size it: clean runs as they are, plus one for a short escape or five for \uXXXX. */
+	for (ptr=str;;ptr++)
+	{
+		run=clean_run(ptr,end,str);len+=run;ptr+=run;
+		if (!(token=*ptr)) break;
+		if (strchr(_T("\"\\\b\f\n\r\t"),token)) len+=2; else len+=6;
+	}
 	
-	out=(PFCHAR*)cJSON_malloc((len+3)*sizeof(PFCHAR));
-	if (!out) return 0;
+	if (!(out=ensure(p,len+2))) return 0;
 
 	ptr2=out;ptr=str;
 	*ptr2++=_T('\"');
 	while (*ptr)
 	{
-		if ((UPFCHAR)*ptr>31 && *ptr!=_T('\"') && *ptr!=_T('\\')) *ptr2++=*ptr++;
+		if ((run=clean_run(ptr,end,str))) {memcpy(ptr2,ptr,run*sizeof(PFCHAR));ptr+=run;ptr2+=run;}
 		else
 		{
 			*ptr2++=_T('\\');
@@ -274,354 +1075,2077 @@ static PFCHAR *print_string_ptr(const PFCHAR *str)
 			}
 		}
 	}
-	*ptr2++=_T('\"');*ptr2++=0;
-	return out;
+	*ptr2=_T('\"');
+	p->offset+=len+2;
+	return 1;
 }
 /* Invote print_string_ptr (which is useful) on an item. */
-static PFCHAR *print_string(cJSON *item)	{return print_string_ptr(item->valuestring);}
+static int print_string(cJSON *item,printbuffer *p)	{return print_string_ptr(item->valuestring,p);}
 
 /* Predeclare these prototypes. */
-static const PFCHAR *parse_value(cJSON *item,const PFCHAR *value);
-static PFCHAR *print_value(cJSON *item,int depth,int fmt);
-static const PFCHAR *parse_array(cJSON *item,const PFCHAR *value);
-static PFCHAR *print_array(cJSON *item,int depth,int fmt);
-static const PFCHAR *parse_object(cJSON *item,const PFCHAR *value);
-static PFCHAR *print_object(cJSON *item,int depth,int fmt);
+static const PFCHAR *parse_value(cJSON *item,const PFCHAR *value,parse_state *ps);
+static int print_value(cJSON *item,int depth,int fmt,printbuffer *p);
+static const PFCHAR *parse_array(cJSON *item,const PFCHAR *value,parse_state *ps);
+static const PFCHAR *parse_object(cJSON *item,const PFCHAR *value,parse_state *ps);
+static const PFCHAR *project_value(cJSON *item,const PFCHAR *value,int node,parse_state *ps);
 
 /* Utility to jump whitespace and cr/lf */
-static const PFCHAR *skip(const PFCHAR *in) {while (in && *in && (UPFCHAR)*in<=32) in++; return in;}
+static const PFCHAR *skip(const PFCHAR *in,parse_state *ps) {while (in && in<ps->end && *in && (UPFCHAR)*in<=32) in++; return in;}
 
-/* Parse an object - create a new root, and populate. */
-cJSON *cJSON_ParseWithOpts(const PFCHAR *value,const PFCHAR **return_parse_end,int require_null_terminated)
+/* Find the quote closing the string that opens at ptr, or end. Only escapes are looked at, nothing is checked. */
+static const PFCHAR *skip_string(const PFCHAR *ptr,const PFCHAR *end)
 {
-	const PFCHAR *end=0;
-	cJSON *c=cJSON_New_Item();
-	ep=0;
-	if (!c) return 0;       /* memory fail */
-
-	end=parse_value(c,skip(value));
-	if (!end)	{cJSON_Delete(c);return 0;}	/* parse failure. ep is set. */
-
-	/* if we require null-terminated JSON without appended garbage, skip and then check for a null terminator */
-	if (require_null_terminated) {end=skip(end);if (*end) {cJSON_Delete(c);ep=end;return 0;}}
-	if (return_parse_end) *return_parse_end=end;
-	return c;
+	const PFCHAR *from=ptr;
+	for (ptr++;ptr<end && *ptr!=_T('\"');)
+	{
+		ptr+=clean_run(ptr,end,from);
+		if (ptr<end && *ptr==_T('\\')) ptr+=(end-ptr>1)?2:1;
+		else if (ptr<end && *ptr!=_T('\"')) ptr++;	/* a raw control character. */
+	}
+	return ptr;
 }
-/* Default options for cJSON_Parse */
-cJSON *cJSON_Parse(const PFCHAR *value) {return cJSON_ParseWithOpts(value,0,0);}
 
-/* Render a cJSON item/entity/structure to text. */
-PFCHAR *cJSON_Print(cJSON *item)				{return print_value(item,0,1);}
-PFCHAR *cJSON_PrintUnformatted(cJSON *item)	{return print_value(item,0,0);}
-
-/* Parser core - when encountering text, process appropriately. */
-static const PFCHAR *parse_value(cJSON *item,const PFCHAR *value)
+/* Find the bracket closing the array or object that opens at ptr, matching brackets outside of strings, or end. */
+static const PFCHAR *skip_brackets(const PFCHAR *ptr,const PFCHAR *end)
 {
-	if (!value)						return 0;	/* Fail on null. */
-	if (!strncmp(value,_T("null"),4))	{ item->type=cJSON_NULL;  return value+4; }
-	if (!strncmp(value,_T("false"),5))	{ item->type=cJSON_False; return value+5; }
-	if (!strncmp(value,_T("true"),4))	{ item->type=cJSON_True; item->valueint=1;	return value+4; }
-	if (*value==_T('\"'))				{ return parse_string(item,value); }
-	if (*value==_T('-') || (*value>=_T('0') && *value<=_T('9')))	{ return parse_number(item,value); }
-	if (*value==_T('['))				{ return parse_array(item,value); }
-	if (*value==_T('{'))				{ return parse_object(item,value); }
-
-	ep=value;return 0;	/* failure. */
+	int depth=0;
+	for (;ptr<end;ptr++)
+	{
+		if (*ptr==_T('\"')) {if ((ptr=skip_string(ptr,end))>=end) break;}
+		else if (*ptr==_T('[') || *ptr==_T('{')) depth++;
+		else if ((*ptr==_T(']') || *ptr==_T('}')) && !--depth) break;
+	}
+	return ptr;
 }
 
-/* Render a value to text. */
-static PFCHAR *print_value(cJSON *item,int depth,int fmt)
+/* Lazy parsing: record an array or object as the span of its text, found by skip_brackets,
+and leave its children to expand() until they are asked for. */
+static const PFCHAR *parse_lazy(cJSON *item,const PFCHAR *value,parse_state *ps)
 {
-	PFCHAR *out=0;
-	if (!item) return 0;
-	switch ((item->type)&255)
+	const PFCHAR *ptr=skip_brackets(value,ps->end),*end=ps->end;
+	if (ptr>=end) {ps->ep=end;return 0;}	/* unbalanced. */
+	if (ptr+1-value>INT_MAX) return (*value==_T('['))?parse_array(item,value,ps):parse_object(item,value,ps);	/* too long to record: expand this level now. */
+	item->type=((*value==_T('['))?cJSON_Array:cJSON_Object)|cJSON_IsLazy;
+	item->valuestring=(PFCHAR*)value;item->valueint=(int)(ptr+1-value);
+	return ptr+1;
+}
+
+/* Parse an object - create a new root, and populate. */
+static cJSON *parse_root(const PFCHAR *value,size_t length,const PFCHAR **return_parse_end,int require_null_terminated,parse_state *ps)
+{
+	const PFCHAR *end=0;arena_chunk *chunk=0;size_t used=0;
+	cJSON *c;
+	ps->end=value?value+length:0;
+	if (ps->arena) {chunk=ps->arena->current;used=chunk?chunk->used:0;}
+	c=parse_new_item(ps);
+	ps->ep=0;
+	if (!c) return 0;       /* memory fail */
+
+	end=parse_value(c,skip(value,ps),ps);
+	/* if we require null-terminated JSON without appended garbage, skip and then check for a null terminator (or the end of the input) */
+	if (end && require_null_terminated) {end=skip(end,ps);if (end<ps->end && *end) {ps->ep=end;end=0;}}
+	if (!end)	/* parse failure. ep is set. */
+	{
+		/* A failed arena parse hands back what it took, so the arena can be reused without a reset. */
+		if (ps->arena) arena_rewind(ps->arena,chunk,used); else delete_item(c,&ps->hooks);
+		return 0;
+	}
+	if (return_parse_end) *return_parse_end=end;
+	return c;
+}
+
+/* The legacy entry points share one error pointer, so they are not safe to call from several threads at once. */
+cJSON *cJSON_ParseWithLengthOpts(const PFCHAR *value,size_t length,const PFCHAR **return_parse_end,int require_null_terminated)
+{
+	parse_state ps;cJSON *c;
+	parse_init(&ps,0);
+	c=parse_root(value,length,return_parse_end,require_null_terminated,&ps);
+	ep=ps.ep;
+	return c;
+}
+cJSON *cJSON_ParseWithOpts(const PFCHAR *value,const PFCHAR **return_parse_end,int require_null_terminated)
+{
+	return cJSON_ParseWithLengthOpts(value,value?strlen(value):0,return_parse_end,require_null_terminated);
+}
+
+cJSON *cJSON_ParseInArenaWithOpts(cJSON_Arena *arena,const PFCHAR *value,const PFCHAR **return_parse_end,int require_null_terminated)
+{
+	parse_state ps;cJSON *c;
+	if (!arena) return 0;
+	parse_init(&ps,0);ps.arena=arena;
+	c=parse_root(value,value?strlen(value):0,return_parse_end,require_null_terminated,&ps);
+	ep=ps.ep;
+	return c;
+}
+/* In-situ parses unescape strings over the input itself, so only the nodes are allocated. */
+cJSON *cJSON_ParseInSituWithLength(PFCHAR *value,size_t length)
+{
+	parse_state ps;cJSON *c;
+	parse_init(&ps,0);ps.insitu=1;
+	c=parse_root(value,length,0,0,&ps);
+	ep=ps.ep;
+	return c;
+}
+cJSON *cJSON_ParseInSitu(PFCHAR *value) {return cJSON_ParseInSituWithLength(value,value?strlen(value):0);}
+
+/* Lazy parses only find where each array and object ends; their children are parsed when first asked for. */
+cJSON *cJSON_ParseLazyWithLength(const PFCHAR *value,size_t length)
+{
+	parse_state ps;cJSON *c;
+	parse_init(&ps,0);ps.lazy=1;
+	c=parse_root(value,length,0,0,&ps);
+	ep=ps.ep;
+	return c;
+}
+cJSON *cJSON_ParseLazy(const PFCHAR *value) {return cJSON_ParseLazyWithLength(value,value?strlen(value):0);}
+
+/* Default options for cJSON_Parse */
+cJSON *cJSON_Parse(const PFCHAR *value) {return cJSON_ParseWithOpts(value,0,0);}
+cJSON *cJSON_ParseWithLength(const PFCHAR *value,size_t length) {return cJSON_ParseWithLengthOpts(value,length,0,0);}
+cJSON *cJSON_ParseInArena(cJSON_Arena *arena,const PFCHAR *value) {return cJSON_ParseInArenaWithOpts(arena,value,0,0);}
+
+/* Parallel parsing. A pre-scan matches brackets outside of strings to find top-level commas (or newlines, for NDJSON)
+near even splits of the input; each chunk is then parsed on its own thread into a chain of items, and the chains are
+joined under one array. */
+#define PARALLEL_MIN_CHUNK 65536	/* below this much text per thread, starting the thread costs more than it saves. */
+typedef struct {
+	const PFCHAR *start,*end;	/* the chunk's text, without the separators around it. */
+	int ndjson;					/* records are separated by whitespace rather than commas. */
+	int optional;				/* the chunk may hold no elements: the array is empty. */
+	cJSON *head,*tail;			/* the items parsed. */
+	const PFCHAR *ep;int failed;
+#if !defined(CJSON_NO_THREADS) && defined(_WIN32)
+	HANDLE thread;
+#elif !defined(CJSON_NO_THREADS)
+	pthread_t thread;
+#endif
+	int started;
+} parallel_chunk;
+
+/* Parse every element of a chunk. Each thread has its own parse state; only the allocator is shared. */
+static void *parallel_worker(void *arg)
+{
+	parallel_chunk *chunk=(parallel_chunk*)arg;parse_state ps;const PFCHAR *value;cJSON *item;
+	parse_init(&ps,0);ps.end=chunk->end;
+	if (!chunk->ndjson) ps.max_depth--;	/* the elements already sit one level down, inside the array. */
+	value=skip(chunk->start,&ps);
+	if (value>=ps.end && (chunk->ndjson || chunk->optional)) return 0;
+	for (;;)
+	{
+		if (!(item=parse_new_item(&ps))) {chunk->failed=1;return 0;}
+		if (chunk->tail) {chunk->tail->next=item;item->prev=chunk->tail;} else chunk->head=item;
+		chunk->tail=item;
+		if (!(value=skip(parse_value(item,value,&ps),&ps))) {chunk->failed=1;chunk->ep=ps.ep;return 0;}
+		if (value>=ps.end) return 0;
+		if (!chunk->ndjson)
+		{
+			if (*value!=_T(',')) {chunk->failed=1;chunk->ep=value;return 0;}
+			value=skip(value+1,&ps);
+		}
+	}
+}
+#if !defined(CJSON_NO_THREADS) && defined(_WIN32)
+static DWORD WINAPI parallel_thread(LPVOID arg) {parallel_worker(arg);return 0;}
+#endif
+
+/* Run the chunks, the first on the calling thread. A thread that can't be started has its chunk run here instead. */
+static cJSON *parallel_run(parallel_chunk *chunks,int count)
+{
+	int i;cJSON *c;
+	for (i=1;i<count;i++)
+	{
+#if !defined(CJSON_NO_THREADS) && defined(_WIN32)
+		chunks[i].started=(chunks[i].thread=CreateThread(0,0,parallel_thread,&chunks[i],0,0))!=0;
+#elif !defined(CJSON_NO_THREADS)
+		chunks[i].started=!pthread_create(&chunks[i].thread,0,parallel_worker,&chunks[i]);
+#endif
+		if (!chunks[i].started) parallel_worker(&chunks[i]);
+	}
+	parallel_worker(&chunks[0]);
+	for (i=1;i<count;i++) if (chunks[i].started)
+	{
+#if !defined(CJSON_NO_THREADS) && defined(_WIN32)
+		WaitForSingleObject(chunks[i].thread,INFINITE);CloseHandle(chunks[i].thread);
+#elif !defined(CJSON_NO_THREADS)
+		pthread_join(chunks[i].thread,0);
+#endif
+	}
+
+	c=cJSON_New_Item();
+	for (i=0;i<count && c;i++) if (chunks[i].failed) {ep=chunks[i].ep;cJSON_Delete(c);c=0;}
+	if (c) c->type=cJSON_Array;
+	for (i=0;i<count;i++)
+	{
+		if (!chunks[i].head) continue;
+		if (!c) {cJSON_Delete(chunks[i].head);continue;}
+		if (!c->child) c->child=chunks[i].head;
+		else {c->child->prev->next=chunks[i].head;chunks[i].head->prev=c->child->prev;}
+		c->child->prev=chunks[i].tail;
+	}
+	return c;
+}
+
+/* How many chunks to cut length PFCHARs into for threads threads. */
+static int parallel_count(size_t length,int threads)
+{
+	size_t most=length/PARALLEL_MIN_CHUNK;
+	if (threads<1) threads=1;
+	return ((size_t)threads>most)?(most?(int)most:1):threads;
+}
+
+/* Cut the array opening at value into up to count chunks at top-level commas. Returns how many, or 0 if it never closes. */
+static int parallel_split(const PFCHAR *value,const PFCHAR *end,parallel_chunk *chunks,int count)
+{
+	const PFCHAR *ptr=value;size_t step=(size_t)(end-value)/count;int depth=0,k=1;
+	chunks[0].start=value+1;
+	for (;ptr<end;ptr++)
+	{
+		if (*ptr==_T('\"')) {if ((ptr=skip_string(ptr,end))>=end) return 0;}
+		else if (*ptr==_T('[') || *ptr==_T('{')) depth++;
+		else if ((*ptr==_T(']') || *ptr==_T('}')) && !--depth) break;
+		else if (*ptr==_T(',') && depth==1 && k<count && (size_t)(ptr-value)>=k*step) {chunks[k-1].end=ptr;chunks[k++].start=ptr+1;}
+	}
+	if (ptr>=end) return 0;
+	chunks[k-1].end=ptr;chunks[0].optional=(k==1);
+	return k;
+}
+
+cJSON *cJSON_ParseParallel(const PFCHAR *value,size_t length,int threads)
+{
+	parse_state ps;const PFCHAR *start;parallel_chunk *chunks;int count=parallel_count(length,threads);cJSON *c;
+	ep=0;	/* no error left over from an earlier parse. */
+	parse_init(&ps,0);ps.end=value?value+length:0;
+	start=skip(value,&ps);
+	if (count<2 || !start || start>=ps.end || *start!=_T('[')) return cJSON_ParseWithLengthOpts(value,length,0,0);	/* nothing to split. */
+	if (!(chunks=(parallel_chunk*)cJSON_malloc(count*sizeof(parallel_chunk)))) return 0;
+	memset(chunks,0,count*sizeof(parallel_chunk));
+	if ((count=parallel_split(start,ps.end,chunks,count))) c=parallel_run(chunks,count);
+	else {ep=ps.end;c=0;}
+	cJSON_free(chunks);
+	return c;
+}
+
+cJSON *cJSON_ParseNDJSONParallel(const PFCHAR *value,size_t length,int threads)
+{
+	const PFCHAR *ptr,*end=value?value+length:0;parallel_chunk *chunks;int count=parallel_count(length,threads),i,k=1;cJSON *c;
+	ep=0;
+	if (!value) return 0;
+	if (!(chunks=(parallel_chunk*)cJSON_malloc(count*sizeof(parallel_chunk)))) return 0;
+	memset(chunks,0,count*sizeof(parallel_chunk));
+	chunks[0].start=value;
+	for (i=1;i<count;i++)	/* cut at the first newline after each even split. */
+	{
+		ptr=value+i*(length/count);
+		if (ptr<chunks[k-1].start) continue;	/* a long record already took this split. */
+		while (ptr<end && *ptr!=_T('\n')) ptr++;
+		if (ptr>=end) break;
+		chunks[k-1].end=ptr;chunks[k++].start=ptr+1;
+	}
+	chunks[k-1].end=end;
+	for (i=0;i<k;i++) chunks[i].ndjson=1;
+	c=parallel_run(chunks,k);
+	cJSON_free(chunks);
+	return c;
+}
+
+/* Record streams: a run of values one after another, usually one per line (NDJSON). The reader finds where each value
+ends without parsing it, reading more until the value is whole, and only then parses it. Records are parsed into an arena
+that is reset for the next one; when the reader owns the buffer, strings are unescaped in place as well. */
+#define RECORD_BUFFER 65536
+struct cJSON_RecordReader {
+	const PFCHAR *text;size_t length,pos;	/* the text held, and where the next record starts. */
+	PFCHAR *buffer;size_t size,bytes;		/* for streams: the buffer, in PFCHARs, and the bytes read into it. */
+	size_t dropped;							/* PFCHARs moved out of the buffer, for offsets. */
+	FILE *file;int fd,eof,failed;
+	cJSON_Arena *arena;cJSON_Hooks hooks;
+};
+
+static cJSON_RecordReader *new_record_reader(cJSON_Hooks *hooks)
+{
+	cJSON_Hooks h;cJSON_RecordReader *r;
+	get_hooks(&h,hooks);
+	if (!(r=(cJSON_RecordReader*)h.malloc_fn(sizeof(cJSON_RecordReader)))) return 0;
+	memset(r,0,sizeof(cJSON_RecordReader));
+	r->hooks=h;r->fd=-1;
+	if (!(r->arena=cJSON_CreateArena(0,&r->hooks))) {h.free_fn(r);return 0;}
+	return r;
+}
+static cJSON_RecordReader *new_stream_reader(FILE *file,int fd,cJSON_Hooks *hooks)
+{
+	cJSON_RecordReader *r=new_record_reader(hooks);
+	if (!r) return 0;
+	r->file=file;r->fd=fd;r->size=RECORD_BUFFER;
+	if (!(r->buffer=(PFCHAR*)r->hooks.malloc_fn(r->size*sizeof(PFCHAR)))) {cJSON_DeleteRecordReader(r);return 0;}
+	r->text=r->buffer;
+	return r;
+}
+cJSON_RecordReader *cJSON_CreateRecordReader(const PFCHAR *text,size_t length,cJSON_Hooks *hooks)
+{
+	cJSON_RecordReader *r=new_record_reader(hooks);
+	if (!r) return 0;
+	r->text=text;r->length=text?length:0;r->eof=1;
+	return r;
+}
+cJSON_RecordReader *cJSON_CreateRecordReaderFromFile(FILE *file,cJSON_Hooks *hooks)	{return file?new_stream_reader(file,-1,hooks):0;}
+cJSON_RecordReader *cJSON_CreateRecordReaderFromFd(int fd,cJSON_Hooks *hooks)			{return (fd>=0)?new_stream_reader(0,fd,hooks):0;}
+
+void cJSON_DeleteRecordReader(cJSON_RecordReader *r)
+{
+	if (!r) return;
+	cJSON_DeleteArena(r->arena);
+	if (r->buffer) r->hooks.free_fn(r->buffer);
+	r->hooks.free_fn(r);
+}
+
+/* Move the unread text to the front of the buffer, doubling it if that leaves no room, and read as much as fits. */
+static void record_fill(cJSON_RecordReader *r)
+{
+	char *bytes;size_t room;long got;
+	if (r->pos)
+	{
+		r->bytes-=r->pos*sizeof(PFCHAR);r->dropped+=r->pos;
+		memmove(r->buffer,r->buffer+r->pos,r->bytes);r->pos=0;
+	}
+	if (r->bytes>=r->size*sizeof(PFCHAR))
+	{
+		PFCHAR *grown;
+		if (r->size>((size_t)-1)/(2*sizeof(PFCHAR)) || !(grown=(PFCHAR*)r->hooks.malloc_fn(2*r->size*sizeof(PFCHAR)))) {r->failed=1;return;}
+		memcpy(grown,r->buffer,r->bytes);r->hooks.free_fn(r->buffer);
+		r->text=r->buffer=grown;r->size*=2;
+	}
+	bytes=(char*)r->buffer+r->bytes;room=r->size*sizeof(PFCHAR)-r->bytes;
+	if (r->file) {got=(long)fread(bytes,1,room,r->file);if (!got && ferror(r->file)) r->failed=1;}
+	else {got=(long)read_fd(r->fd,bytes,room);if (got<0) {r->failed=1;got=0;}}
+	if (!got) r->eof=1;
+	r->bytes+=got;r->length=r->bytes/sizeof(PFCHAR);
+}
+
+/* One past the value that starts at ptr, found without parsing it, or 0 if the text ends before it can be sure. */
+static const PFCHAR *record_end(const PFCHAR *ptr,const PFCHAR *end)
+{
+	if (*ptr==_T('\"')) ptr=skip_string(ptr,end);
+	else if (*ptr==_T('[') || *ptr==_T('{')) ptr=skip_brackets(ptr,end);
+	else
+	{
+		while (ptr<end && (UPFCHAR)*ptr>32 && !strchr(_T(",:[]{}\""),*ptr)) ptr++;	/* a number or literal ends at whatever follows it. */
+		return (ptr<end)?ptr:0;
+	}
+	return (ptr<end)?ptr+1:0;
+}
+
+cJSON *cJSON_ReadRecord(cJSON_RecordReader *r)
+{
+	parse_state ps;const PFCHAR *start,*stop=0,*end;cJSON *c;
+	if (!r || r->failed) return 0;
+	cJSON_ResetArena(r->arena);	/* the last record goes. */
+	parse_init(&ps,&r->hooks);
+	for (;;)
+	{
+		ps.end=end=r->text+r->length;
+		start=skip(r->text+r->pos,&ps);
+		r->pos=start-r->text;
+		if (start<end && ((stop=record_end(start,end)) || r->eof)) break;
+		if (start>=end && r->eof) return 0;	/* no more records. */
+		record_fill(r);
+		if (r->failed) return 0;
+	}
+	if (!stop) stop=end;	/* the last value runs to the end of the input; let the parser judge it. */
+	ps.arena=r->arena;ps.insitu=(r->buffer!=0);
+	c=parse_root(start,stop-start,&start,0,&ps);
+	ep=ps.ep;
+	if (!c) {r->failed=1;if (ps.ep) r->pos=ps.ep-r->text;return 0;}
+	r->pos=start-r->text;
+	return c;
+}
+
+size_t cJSON_GetRecordReaderOffset(cJSON_RecordReader *r)	{return r?r->dropped+r->pos:0;}
+int cJSON_RecordReaderFailed(cJSON_RecordReader *r)			{return !r || r->failed;}
+
+/* The writer is a print buffer that records are appended to. */
+struct cJSON_RecordWriter {printbuffer p;};
+
+cJSON_RecordWriter *cJSON_CreateRecordWriter(cJSON_Hooks *hooks)
+{
+	cJSON_Hooks h;cJSON_RecordWriter *w;
+	get_hooks(&h,hooks);
+	if (!(w=(cJSON_RecordWriter*)h.malloc_fn(sizeof(cJSON_RecordWriter)))) return 0;
+	memset(w,0,sizeof(cJSON_RecordWriter));
+	w->p.hooks=h;w->p.length=256;
+	if (!(w->p.buffer=(PFCHAR*)h.malloc_fn(w->p.length*sizeof(PFCHAR)))) {h.free_fn(w);return 0;}
+	w->p.buffer[0]=0;
+	return w;
+}
+
+int cJSON_WriteRecord(cJSON_RecordWriter *w,cJSON *item)
+{
+	size_t offset;
+	if (!w || !item) return 0;
+	offset=w->p.offset;
+	if (!print_value(item,0,0,&w->p) || !print_raw(&w->p,_T("\n"),1)) {w->p.offset=offset;w->p.buffer[offset]=0;return 0;}	/* drop the partial record. */
+	w->p.buffer[w->p.offset]=0;
+	return 1;
+}
+
+const PFCHAR *cJSON_GetRecordWriterText(cJSON_RecordWriter *w,size_t *length)
+{
+	if (length) *length=w?w->p.offset:0;
+	return w?w->p.buffer:0;
+}
+void cJSON_ResetRecordWriter(cJSON_RecordWriter *w)	{if (w) {w->p.offset=0;w->p.buffer[0]=0;}}
+void cJSON_DeleteRecordWriter(cJSON_RecordWriter *w)	{if (w) {w->p.hooks.free_fn(w->p.buffer);w->p.hooks.free_fn(w);}}
+
+/* Generators print straight from calls, laid out exactly as print_value would lay out the same tree.
+Each open container has an entry on the stack; the innermost one decides what may come next. */
+enum {gen_array=1,gen_object=2,gen_members=4};
+struct cJSON_Generator {
+	printbuffer p;int fmt;
+	unsigned char *stack;int depth,stack_size;	/* the kind of each open container, and whether it has members yet. */
+	int has_key;	/* the innermost object has a key waiting for its value. */
+	int done,failed;
+};
+
+static cJSON_Generator *new_generator(int fmt,cJSON_WriteCallback sink,void *user,size_t buffer_size,cJSON_Hooks *hooks)
+{
+	cJSON_Hooks h;cJSON_Generator *g;
+	get_hooks(&h,hooks);
+	if (!(g=(cJSON_Generator*)h.malloc_fn(sizeof(cJSON_Generator)))) return 0;
+	memset(g,0,sizeof(cJSON_Generator));
+	g->p.hooks=h;g->p.sink=sink;g->p.user=user;g->fmt=fmt;
+	g->p.length=buffer_size?buffer_size:(sink?PRINT_SINK_BUFFER:256);
+	if (!(g->p.buffer=(PFCHAR*)h.malloc_fn(g->p.length*sizeof(PFCHAR)))) {h.free_fn(g);return 0;}
+	g->p.buffer[0]=0;
+	return g;
+}
+cJSON_Generator *cJSON_CreateGenerator(int fmt,cJSON_Hooks *hooks)	{return new_generator(fmt,0,0,0,hooks);}
+cJSON_Generator *cJSON_CreateGeneratorToSink(int fmt,cJSON_WriteCallback sink,void *user,size_t buffer_size,cJSON_Hooks *hooks)	{return sink?new_generator(fmt,sink,user,buffer_size,hooks):0;}
+
+void cJSON_ResetGenerator(cJSON_Generator *g)
+{
+	if (!g) return;
+	g->p.offset=0;g->p.buffer[0]=0;
+	g->depth=g->has_key=g->done=g->failed=0;
+}
+void cJSON_DeleteGenerator(cJSON_Generator *g)
+{
+	if (!g) return;
+	if (g->stack) g->p.hooks.free_fn(g->stack);
+	g->p.hooks.free_fn(g->p.buffer);g->p.hooks.free_fn(g);
+}
+
+static int gen_fail(cJSON_Generator *g)	{g->failed=1;return 0;}
+
+/* Check a value may go here, and write the separator before it. */
+static int gen_value(cJSON_Generator *g)
+{
+	unsigned char *top;
+	if (!g || g->failed) return 0;
+	if (!g->depth) {if (g->done) return gen_fail(g); g->done=1; return 1;}	/* one root value. */
+	top=&g->stack[g->depth-1];
+	if (*top&gen_object) {if (!g->has_key) return gen_fail(g); g->has_key=0; return 1;}
+	if ((*top&gen_members) && !print_raw(&g->p,_T(", "),g->fmt?2:1)) return gen_fail(g);
+	*top|=gen_members;
+	return 1;
+}
+
+static int gen_begin(cJSON_Generator *g,int kind)
+{
+	if (!gen_value(g)) return 0;
+	if (g->depth==g->stack_size)
+	{
+		int size=g->stack_size?g->stack_size*2:16;unsigned char *grown=(unsigned char*)g->p.hooks.malloc_fn(size);
+		if (!grown) return gen_fail(g);
+		if (g->stack) {memcpy(grown,g->stack,g->depth);g->p.hooks.free_fn(g->stack);}
+		g->stack=grown;g->stack_size=size;
+	}
+	g->stack[g->depth++]=(unsigned char)kind;
+	if (kind==gen_object) return print_raw(&g->p,_T("{\n"),g->fmt?2:1) || gen_fail(g);
+	return print_raw(&g->p,_T("["),1) || gen_fail(g);
+}
+int cJSON_GenBeginObject(cJSON_Generator *g)	{return gen_begin(g,gen_object);}
+int cJSON_GenBeginArray(cJSON_Generator *g)		{return gen_begin(g,gen_array);}
+
+int cJSON_GenEndObject(cJSON_Generator *g)
+{
+	int members,ok;
+	if (!g || g->failed) return 0;
+	if (!g->depth || !(g->stack[g->depth-1]&gen_object) || g->has_key) return gen_fail(g);
+	members=g->stack[--g->depth]&gen_members;
+	if (!g->fmt) ok=1;
+	else if (members) ok=print_raw(&g->p,_T("\n"),1) && print_tabs(&g->p,g->depth);
+	else ok=print_tabs(&g->p,g->depth-1);	/* as print_value: an empty object closes one tab short. */
+	return (ok && print_raw(&g->p,_T("}"),1)) || gen_fail(g);
+}
+int cJSON_GenEndArray(cJSON_Generator *g)
+{
+	if (!g || g->failed) return 0;
+	if (!g->depth || !(g->stack[g->depth-1]&gen_array)) return gen_fail(g);
+	g->depth--;
+	return print_raw(&g->p,_T("]"),1) || gen_fail(g);
+}
+
+int cJSON_GenKey(cJSON_Generator *g,const PFCHAR *key)
+{
+	unsigned char *top;
+	if (!g || g->failed) return 0;
+	if (!key || !g->depth || !(g->stack[g->depth-1]&gen_object) || g->has_key) return gen_fail(g);
+	top=&g->stack[g->depth-1];
+	if ((*top&gen_members) && !print_raw(&g->p,_T(",\n"),g->fmt?2:1)) return gen_fail(g);
+	if (g->fmt && !print_tabs(&g->p,g->depth)) return gen_fail(g);
+	if (!print_string_ptr(key,&g->p) || !print_raw(&g->p,_T(":\t"),g->fmt?2:1)) return gen_fail(g);
+	*top|=gen_members;g->has_key=1;
+	return 1;
+}
+
+int cJSON_GenNumber(cJSON_Generator *g,double number)
+{
+	cJSON item;
+	memset(&item,0,sizeof(cJSON));item.valuedouble=number;
+	return gen_value(g) && (print_number(&item,&g->p) || gen_fail(g));
+}
+int cJSON_GenString(cJSON_Generator *g,const PFCHAR *string)	{return gen_value(g) && (print_string_ptr(string,&g->p) || gen_fail(g));}
+int cJSON_GenBool(cJSON_Generator *g,int b)						{return gen_value(g) && (print_raw(&g->p,b?_T("true"):_T("false"),b?4:5) || gen_fail(g));}
+int cJSON_GenNull(cJSON_Generator *g)							{return gen_value(g) && (print_raw(&g->p,_T("null"),4) || gen_fail(g));}
+int cJSON_GenItem(cJSON_Generator *g,cJSON *item)				{return gen_value(g) && (print_value(item,g->depth,g->fmt,&g->p) || gen_fail(g));}
+
+int cJSON_FinishGenerator(cJSON_Generator *g)
+{
+	if (!g || g->failed) return 0;
+	if (g->depth || !g->done) return gen_fail(g);	/* unclosed, or nothing written. */
+	if (g->p.sink && g->p.offset) {if (!g->p.sink(g->p.user,g->p.buffer,g->p.offset)) return gen_fail(g); g->p.offset=0;}
+	g->p.buffer[g->p.offset]=0;
+	return 1;
+}
+
+const PFCHAR *cJSON_GetGeneratorText(cJSON_Generator *g,size_t *length)
+{
+	if (length) *length=g?g->p.offset:0;
+	if (!g) return 0;
+	g->p.buffer[g->p.offset]=0;	/* ensure always leaves room for this. */
+	return g->p.buffer;
+}
+
+/* Contexts: everything a call needs travels with it, so threads using separate contexts share nothing. */
+void cJSON_InitContext(cJSON_Context *ctx,cJSON_Hooks *hooks)
+{
+	memset(ctx,0,sizeof(cJSON_Context));
+	if (hooks) ctx->hooks=*hooks;
+	get_hooks(&ctx->hooks,&ctx->hooks);	/* fill any gaps with malloc/free. */
+}
+
+cJSON *cJSON_ParseWithContext(cJSON_Context *ctx,const PFCHAR *value,const PFCHAR **return_parse_end)
+{
+	parse_state ps;cJSON *c;const PFCHAR *ptr,*end=0;double t=0;
+	parse_init(&ps,&ctx->hooks);ps.arena=ctx->arena;ps.keys=ctx->keys;
+	if (ctx->max_depth>0) ps.max_depth=ctx->max_depth;
+	if (ctx->stats)
+	{
+		memset(ctx->stats,0,sizeof(cJSON_Stats));
+		ps.stats=ctx->stats;ps.timed=(ctx->flags&cJSON_TimeStats)!=0;
+		t=stats_clock();
+	}
+	c=parse_root(value,value?strlen(value):0,&end,ctx->flags&cJSON_RequireNullTerminated,&ps);
+	if (c && return_parse_end) *return_parse_end=end;
+	if (ctx->stats) {ctx->stats->total_us=stats_clock()-t;ctx->stats->text_length=c?end-value:ps.ep?ps.ep-value:0;}
+	ctx->error_ptr=ps.ep;ctx->error_line=ctx->error_column=0;
+	if (ps.ep)
+	{
+		ctx->error_line=ctx->error_column=1;
+		for (ptr=value;ptr<ps.ep;ptr++) if (*ptr==_T('\n')) ctx->error_line++,ctx->error_column=1; else ctx->error_column++;
+	}
+	return c;
+}
+
+void cJSON_DeleteWithContext(cJSON_Context *ctx,cJSON *c)
+{
+	cJSON_Hooks hooks;
+	if (ctx->arena) return;	/* released with the arena. */
+	get_hooks(&hooks,&ctx->hooks);
+	delete_item(c,&hooks);
+}
+
+/* Render a cJSON item/entity/structure to text, in a single growable buffer. */
+/* A context, if given, supplies the allocator and takes the statistics. */
+static PFCHAR *print(cJSON *item,int prebuffer,int fmt,const cJSON_Context *ctx)
+{
+	printbuffer p;double t=0;
+	memset(&p,0,sizeof(printbuffer));
+	get_hooks(&p.hooks,ctx?&ctx->hooks:0);
+	if (ctx) {p.realloc_fn=ctx->realloc_fn;p.stats=ctx->stats;}
+	if (p.stats) {memset(p.stats,0,sizeof(cJSON_Stats));t=stats_clock();}
+	p.length=(prebuffer>0)?(size_t)prebuffer:256;
+	stats_alloc(p.stats,p.length*sizeof(PFCHAR));
+	p.buffer=(PFCHAR*)p.hooks.malloc_fn(p.length*sizeof(PFCHAR));
+	if (!p.buffer) return 0;
+	if (!print_value(item,0,fmt,&p)) {p.hooks.free_fn(p.buffer);return 0;}
+	p.buffer[p.offset]=0;
+	if (p.stats) {p.stats->text_length=p.offset;p.stats->total_us=stats_clock()-t;}
+	return p.buffer;
+}
+
+PFCHAR *cJSON_Print(cJSON *item)				{return print(item,0,1,0);}
+PFCHAR *cJSON_PrintUnformatted(cJSON *item)	{return print(item,0,0,0);}
+PFCHAR *cJSON_PrintBuffered(cJSON *item,int prebuffer,int fmt)	{return print(item,prebuffer,fmt,0);}
+PFCHAR *cJSON_PrintWithContext(cJSON_Context *ctx,cJSON *item,int fmt)	{return print(item,0,fmt,ctx);}
+
+int cJSON_PrintPreallocated(cJSON *item,PFCHAR *buffer,int length,int fmt)
+{
+	printbuffer p;
+	if (!buffer || length<1) return 0;
+	memset(&p,0,sizeof(printbuffer));
+	p.buffer=buffer;p.length=(size_t)length;p.noalloc=1;get_hooks(&p.hooks,0);
+	if (!print_value(item,0,fmt,&p)) {buffer[0]=0;return 0;}
+	buffer[p.offset]=0;
+	return 1;
+}
+
+/* Print through a sink, buffer_size PFCHARs at a time. */
+int cJSON_PrintToCallback(cJSON *item,int fmt,cJSON_WriteCallback sink,void *user,size_t buffer_size)
+{
+	printbuffer p;int ok;
+	if (!sink) return 0;
+	memset(&p,0,sizeof(printbuffer));
+	get_hooks(&p.hooks,0);
+	p.length=buffer_size?buffer_size:PRINT_SINK_BUFFER;p.sink=sink;p.user=user;
+	if (!(p.buffer=(PFCHAR*)p.hooks.malloc_fn(p.length*sizeof(PFCHAR)))) return 0;
+	ok=print_value(item,0,fmt,&p) && (!p.offset || sink(user,p.buffer,p.offset));
+	p.hooks.free_fn(p.buffer);
+	return ok;
+}
+
+static int file_sink(void *user,const PFCHAR *text,size_t length)	{return fwrite(text,sizeof(PFCHAR),length,(FILE*)user)==length;}
+static int fd_sink(void *user,const PFCHAR *text,size_t length)
+{
+	const char *bytes=(const char*)text;size_t left=length*sizeof(PFCHAR);long n;
+	while (left)	/* sockets and pipes may take less than asked. */
+	{
+		if ((n=(long)write_fd(*(int*)user,bytes,left))<0) {if (errno==EINTR) continue; return 0;}
+		bytes+=n;left-=n;
+	}
+	return 1;
+}
+int cJSON_PrintToFile(cJSON *item,int fmt,FILE *file)	{return file?cJSON_PrintToCallback(item,fmt,file_sink,file,0):0;}
+int cJSON_PrintToFd(cJSON *item,int fmt,int fd)			{return (fd>=0)?cJSON_PrintToCallback(item,fmt,fd_sink,&fd,0):0;}
+
+/* Parse a member name into item->string. With a key table the name is interned, looked up where it stands in the
+text unless it has escapes to decode; it is marked cJSON_StringIsConst once the value has set the type. */
+static const PFCHAR *parse_key(cJSON *item,const PFCHAR *value,parse_state *ps)
+{
+	const PFCHAR *ptr;size_t run;PFCHAR *decoded;
+	if (ps->keys && value<ps->end && *value==_T('\"'))
+	{
+		run=clean_run(value+1,ps->end,value);ptr=value+1+run;
+		if (ptr<ps->end && *ptr==_T('\"'))
+		{
+			if (ps->stats) ps->stats->string_bytes+=run;
+			return (item->string=(PFCHAR*)intern(ps->keys,value+1,run,ps->stats))?ptr+1:0;
+		}
+	}
+	if (!(value=parse_string(item,value,ps))) return 0;
+	decoded=item->valuestring;item->valuestring=0;
+	if (!ps->keys) {item->string=decoded;return value;}
+	item->string=(PFCHAR*)intern(ps->keys,decoded,strlen(decoded),ps->stats);
+	if (!ps->arena && !ps->insitu) ps->hooks.free_fn(decoded);
+	return item->string?value:0;
+}
+/* A member's name and the colon after it, landing on its value. */
+static const PFCHAR *parse_name(cJSON *item,const PFCHAR *value,parse_state *ps)
+{
+	double t=0;
+	if (ps->timed) t=stats_clock();
+	value=parse_key(item,skip(value,ps),ps);
+	if (ps->timed) ps->stats->string_us+=stats_clock()-t;
+	value=skip(value,ps);
+	if (!value) return 0;
+	if (value>=ps->end || *value!=_T(':')) {ps->ep=value;return 0;}	/* fail! */
+	return skip(value+1,ps);
+}
+
+/* Parser core - when encountering text, process appropriately. Arrays and objects don't recurse: the open ones are
+kept on a stack, so nesting costs a pointer each rather than a C stack frame, and stops at ps->max_depth. lazy says
+whether the value itself may be left lazy; everything inside it follows ps->lazy. */
+#define PARSE_STACK 32	/* open containers held without allocating. */
+static const PFCHAR *parse_tree(cJSON *item,const PFCHAR *value,parse_state *ps,int lazy)
+{
+	cJSON *local[PARSE_STACK],**stack=local,**grown,*parent,*child;int depth=0,size=PARSE_STACK,object,i;double t=0;
+	while (value)
+	{
+		/* Parse one value into item. A non-empty array or object is opened, and its first child is next. */
+		if (value>=ps->end)				{ps->ep=value;value=0;}	/* out of input. */
+		else if (ps->end-value>=4 && !strncmp(value,_T("null"),4))	{ item->type=cJSON_NULL;  value+=4; }
+		else if (ps->end-value>=5 && !strncmp(value,_T("false"),5))	{ item->type=cJSON_False; value+=5; }
+		else if (ps->end-value>=4 && !strncmp(value,_T("true"),4))	{ item->type=cJSON_True; item->valueint=1;	value+=4; }
+		else if (*value==_T('\"') && ps->timed)	{ t=stats_clock(); value=parse_string(item,value,ps); ps->stats->string_us+=stats_clock()-t; }
+		else if (*value==_T('\"'))				{ value=parse_string(item,value,ps); }
+		else if ((*value==_T('-') || (*value>=_T('0') && *value<=_T('9'))) && ps->timed)	{ t=stats_clock(); value=parse_number(item,value,ps); ps->stats->number_us+=stats_clock()-t; }
+		else if (*value==_T('-') || (*value>=_T('0') && *value<=_T('9')))	{ value=parse_number(item,value,ps); }
+		else if ((depth?ps->lazy:lazy) && (*value==_T('[') || *value==_T('{')))	{ value=parse_lazy(item,value,ps); }
+		else if (*value==_T('[') || *value==_T('{'))
+		{
+			object=(*value==_T('{'));
+			if (depth>=ps->max_depth) {ps->ep=value;value=0;break;}	/* nested too deep. */
+			item->type=object?cJSON_Object:cJSON_Array;
+			stats_depth(ps->stats,depth+1);
+			value=skip(value+1,ps);
+			if (value<ps->end && *value==(object?_T('}'):_T(']'))) value++;	/* empty. */
+			else
+			{
+				if (depth==size)
+				{
+					stats_alloc(ps->stats,2*size*sizeof(cJSON*));
+					if (!(grown=(cJSON**)ps->hooks.malloc_fn(2*size*sizeof(cJSON*)))) {value=0;break;}
+					memcpy(grown,stack,size*sizeof(cJSON*));
+					if (stack!=local) ps->hooks.free_fn(stack);
+					stack=grown;size*=2;
+				}
+				if (!(item->child=child=parse_new_item(ps))) {value=0;break;}	/* memory fail */
+				stack[depth++]=item;item=child;
+				if (object) value=parse_name(item,value,ps);
+				continue;
+			}
+		}
+		else {ps->ep=value;value=0;}	/* failure. */
+
+		/* item is complete: go on to its next sibling, or close the containers it finishes. */
+		while (value && depth)
+		{
+			parent=stack[depth-1];object=((parent->type&255)==cJSON_Object);
+			if (object && (ps->insitu || ps->keys)) item->type|=cJSON_StringIsConst;
+			value=skip(value,ps);
+			if (value<ps->end && *value==_T(','))
+			{
+				if (!(child=parse_new_item(ps))) {value=0;break;}	/* memory fail */
+				item->next=child;child->prev=item;item=child;
+				value=skip(value+1,ps);
+				if (object) value=parse_name(item,value,ps);
+				break;
+			}
+			if (value<ps->end && *value==(object?_T('}'):_T(']'))) {parent->child->prev=item;item=parent;depth--;value++;}	/* the head points at the tail. */
+			else {ps->ep=value;value=0;}	/* malformed. */
+		}
+		if (!depth) break;
+	}
+	/* On failure, the members still open have names the tree must not free: keys from the table, or in the input. */
+	if (!value && depth && (ps->insitu || ps->keys))
+		for (i=0;i<depth;i++) if ((stack[i]->type&255)==cJSON_Object) ((i+1<depth)?stack[i+1]:item)->type|=cJSON_StringIsConst;
+	if (stack!=local) ps->hooks.free_fn(stack);
+	return value;
+}
+static const PFCHAR *parse_value(cJSON *item,const PFCHAR *value,parse_state *ps)
+{
+	if (!value) return 0;	/* Fail on null. */
+	if (ps->projection) return project_value(item,value,0,ps);
+	return parse_tree(item,value,ps,ps->lazy);
+}
+/* Parse an array or object, one level at least: its children are lazy if ps->lazy is set. */
+static const PFCHAR *parse_array(cJSON *item,const PFCHAR *value,parse_state *ps)
+{
+	if (*value!=_T('['))	{ps->ep=value;return 0;}	/* not an array! */
+	return parse_tree(item,value,ps,0);
+}
+static const PFCHAR *parse_object(cJSON *item,const PFCHAR *value,parse_state *ps)
+{
+	if (*value!=_T('{'))	{ps->ep=value;return 0;}	/* not an object! */
+	return parse_tree(item,value,ps,0);
+}
+
+/* Render a value to text. Arrays and objects don't recurse: the open ones are kept on a stack, and their
+children are laid out as they always were, children indented one deeper than the container. */
+#define PRINT_STACK 32
+static int print_value(cJSON *item,int depth,int fmt,printbuffer *p)
+{
+	cJSON *local[PRINT_STACK],**stack=local,**grown,*parent;int top=0,size=PRINT_STACK,ok=1,d;
+	while (ok)
+	{
+		/* Print item, or open it and go on to its first child. */
+		d=depth+top;
+		if (p->stats && item) p->stats->nodes++;
+		if (!item) ok=0;
+		else if (item->type&cJSON_IsLazy) ok=print_raw(p,item->valuestring,item->valueint);	/* never expanded: the text as it was. */
+		else switch ((item->type)&255)
+		{
+			case cJSON_NULL:	ok=print_raw(p,_T("null"),4);break;
+			case cJSON_False:	ok=print_raw(p,_T("false"),5);break;
+			case cJSON_True:	ok=print_raw(p,_T("true"),4);break;
+			case cJSON_Number:	ok=print_number(item,p);break;
+			case cJSON_String:	ok=print_string(item,p);break;
+			case cJSON_Array:
+			case cJSON_Object:
+				if ((item->type&255)==cJSON_Array) ok=print_raw(p,_T("["),1);
+				else ok=print_raw(p,_T("{\n"),fmt?2:1);
+				if (!ok) break;
+				stats_depth(p->stats,top+1);
+				if (!item->child)	/* an empty object closes one tab short of a populated one. */
+				{
+					if ((item->type&255)==cJSON_Array) ok=print_raw(p,_T("]"),1);
+					else ok=(!fmt || print_tabs(p,d-1)) && print_raw(p,_T("}"),1);
+					break;
+				}
+				if (top==size)
+				{
+					stats_alloc(p->stats,2*size*sizeof(cJSON*));
+					if (!(grown=(cJSON**)p->hooks.malloc_fn(2*size*sizeof(cJSON*)))) {ok=0;break;}
+					memcpy(grown,stack,size*sizeof(cJSON*));
+					if (stack!=local) p->hooks.free_fn(stack);
+					stack=grown;size*=2;
+				}
+				stack[top++]=item;item=item->child;
+				if ((stack[top-1]->type&255)==cJSON_Object) ok=(!fmt || print_tabs(p,d+1)) && print_string_ptr(item->string,p) && print_raw(p,_T(":\t"),fmt?2:1);
+				continue;
+			default: ok=0;
+		}
+
+		/* item is done: go on to its next sibling, or close the containers it finishes. */
+		while (ok && top)
+		{
+			parent=stack[top-1];d=depth+top-1;
+			if ((parent->type&255)==cJSON_Array)
+			{
+				if (item->next) {ok=print_raw(p,_T(", "),fmt?2:1);item=item->next;break;}
+				ok=print_raw(p,_T("]"),1);
+			}
+			else if (item->next)
+			{
+				item=item->next;
+				ok=print_raw(p,_T(",\n"),fmt?2:1) && (!fmt || print_tabs(p,d+1)) && print_string_ptr(item->string,p) && print_raw(p,_T(":\t"),fmt?2:1);
+				break;
+			}
+			else ok=(!fmt || (print_raw(p,_T("\n"),1) && print_tabs(p,d))) && print_raw(p,_T("}"),1);
+			item=parent;top--;
+		}
+		if (!top) break;
+	}
+	if (stack!=local) p->hooks.free_fn(stack);
+	return ok;
+}
+
+/* Streaming (SAX) parser: a state machine fed one chunk at a time. Only the innermost token is buffered, so
+a scalar split across chunks is carried over and then decoded by parse_string/parse_number as usual. */
+enum {sax_value,sax_first_value,sax_key,sax_first_key,sax_colon,sax_after,sax_string,sax_number,sax_literal,sax_failed};
+struct cJSON_SAXParser
+{
+	cJSON_SAXCallbacks callbacks;void *user;
+	cJSON_Hooks hooks;
+	cJSON_Arena *arena;			/* scratch for decoded strings, reset after each event. */
+	int state,is_key,escaped;
+	char *stack;int depth,stack_size;	/* '[' or '{' for each open container. */
+	PFCHAR *token;size_t token_len,token_size;
+	size_t offset;				/* PFCHARs consumed, or the failing one. */
+};
+
+cJSON_SAXParser *cJSON_CreateSAXParser(const cJSON_SAXCallbacks *callbacks,void *user,cJSON_Hooks *hooks)
+{
+	cJSON_Hooks h;cJSON_SAXParser *sax;
+	get_hooks(&h,hooks);
+	if (!(sax=(cJSON_SAXParser*)h.malloc_fn(sizeof(cJSON_SAXParser)))) return 0;
+	memset(sax,0,sizeof(cJSON_SAXParser));
+	if (callbacks) sax->callbacks=*callbacks;
+	sax->user=user;sax->hooks=h;
+	if (!(sax->arena=cJSON_CreateArena(0,&h))) {h.free_fn(sax);return 0;}
+	return sax;
+}
+
+void cJSON_DeleteSAXParser(cJSON_SAXParser *sax)
+{
+	if (!sax) return;
+	cJSON_DeleteArena(sax->arena);
+	sax->hooks.free_fn(sax->stack);
+	sax->hooks.free_fn(sax->token);
+	sax->hooks.free_fn(sax);
+}
+
+size_t cJSON_GetSAXParserOffset(cJSON_SAXParser *sax)	{return sax?sax->offset:0;}
+
+/* Append len PFCHARs to the pending token, keeping it NUL-terminated. */
+static int sax_append(cJSON_SAXParser *sax,const PFCHAR *str,size_t len)
+{
+	PFCHAR *grown;size_t size;
+	if (sax->token_len+len>=sax->token_size)
+	{
+		size=sax->token_size?sax->token_size:64;
+		while (size<=sax->token_len+len) size*=2;
+		if (!(grown=(PFCHAR*)sax->hooks.malloc_fn(size*sizeof(PFCHAR)))) return 0;
+		if (sax->token) {memcpy(grown,sax->token,sax->token_len*sizeof(PFCHAR));sax->hooks.free_fn(sax->token);}
+		sax->token=grown;sax->token_size=size;
+	}
+	memcpy(sax->token+sax->token_len,str,len*sizeof(PFCHAR));
+	sax->token_len+=len;sax->token[sax->token_len]=0;
+	return 1;
+}
+
+/* Open a container and tell the callbacks. */
+static int sax_push(cJSON_SAXParser *sax,char kind)
+{
+	char *grown;int size;
+	if (sax->depth==sax->stack_size)
+	{
+		size=sax->stack_size?sax->stack_size*2:32;
+		if (!(grown=(char*)sax->hooks.malloc_fn(size))) return 0;
+		if (sax->stack) {memcpy(grown,sax->stack,sax->depth);sax->hooks.free_fn(sax->stack);}
+		sax->stack=grown;sax->stack_size=size;
+	}
+	sax->stack[sax->depth++]=kind;
+	sax->state=(kind=='{')?sax_first_key:sax_first_value;
+	if (kind=='{') return !sax->callbacks.start_object || sax->callbacks.start_object(sax->user);
+	return !sax->callbacks.start_array || sax->callbacks.start_array(sax->user);
+}
+
+/* After a complete value: back to the top level for the next document, or on within the container. */
+static void sax_done_value(cJSON_SAXParser *sax)	{sax->state=sax->depth?sax_after:sax_value;}
+
+/* Close the innermost container, which must be of the given kind. */
+static int sax_pop(cJSON_SAXParser *sax,char kind)
+{
+	if (!sax->depth || sax->stack[sax->depth-1]!=kind) return 0;
+	sax->depth--;sax_done_value(sax);
+	if (kind=='{') return !sax->callbacks.end_object || sax->callbacks.end_object(sax->user);
+	return !sax->callbacks.end_array || sax->callbacks.end_array(sax->user);
+}
+
+/* Decode the buffered token with the tree parser's routines and report it. */
+static int sax_emit(cJSON_SAXParser *sax)
+{
+	cJSON item;parse_state ps;const PFCHAR *end=0,*token=sax->token;int ok=1;
+	memset(&item,0,sizeof(cJSON));
+	parse_init(&ps,&sax->hooks);ps.arena=sax->arena;ps.end=token+sax->token_len;
+	if (sax->state==sax_string)				end=parse_string(&item,token,&ps);
+	else if (sax->state==sax_number)		end=parse_number(&item,token,&ps);
+	else if (!strcmp(token,_T("null")))		item.type=cJSON_NULL,end=token+4;
+	else if (!strcmp(token,_T("false")))	item.type=cJSON_False,end=token+5;
+	else if (!strcmp(token,_T("true")))		item.type=cJSON_True,item.valueint=1,end=token+4;
+	if (!end || end!=token+sax->token_len) ok=0;
+	else if (sax->is_key)	{if (sax->callbacks.key) ok=sax->callbacks.key(sax->user,item.valuestring);}
+	else if (sax->callbacks.value) ok=sax->callbacks.value(sax->user,&item);
+	cJSON_ResetArena(sax->arena);
+	sax->token_len=0;
+	if (sax->is_key) sax->state=sax_colon;
+	else sax_done_value(sax);
+	return ok;
+}
+
+int cJSON_FeedSAXParser(cJSON_SAXParser *sax,const PFCHAR *chunk,size_t length)
+{
+	size_t i=0,j;PFCHAR c;int ok=1;
+	if (!sax || sax->state==sax_failed) return 0;
+	while (ok && i<length)
+	{
+		c=chunk[i];
+		switch (sax->state)
+		{
+			case sax_string:	/* take everything up to the next quote or backslash at once. */
+				for (j=i;j<length && chunk[j]!=_T('\"') && chunk[j]!=_T('\\');j++);
+				if (j>i) {sax->escaped=0;ok=sax_append(sax,chunk+i,j-i);i=j;continue;}
+				ok=sax_append(sax,chunk+i,1);i++;
+				if (c==_T('\\')) sax->escaped=!sax->escaped;
+				else if (sax->escaped) sax->escaped=0;
+				else if (ok) ok=sax_emit(sax);
+				continue;
+			case sax_number:
+				if ((c>=_T('0') && c<=_T('9')) || c==_T('-') || c==_T('+') || c==_T('.') || c==_T('e') || c==_T('E')) {ok=sax_append(sax,chunk+i,1);i++;}
+				else ok=sax_emit(sax);	/* c belongs to whatever follows. */
+				continue;
+			case sax_literal:
+				if (c>=_T('a') && c<=_T('z') && sax->token_len<5) {ok=sax_append(sax,chunk+i,1);i++;}
+				else ok=sax_emit(sax);
+				continue;
+		}
+		if ((UPFCHAR)c<=32) {i++;continue;}	/* whitespace between tokens. */
+		switch (sax->state)
+		{
+			case sax_value: case sax_first_value:
+				sax->is_key=0;
+				if (c==_T('{'))			ok=sax_push(sax,'{');
+				else if (c==_T('['))	ok=sax_push(sax,'[');
+				else if (c==_T(']') && sax->state==sax_first_value) ok=sax_pop(sax,'[');
+				else if (c==_T('\"'))	{sax->state=sax_string;sax->escaped=0;ok=sax_append(sax,&c,1);}
+				else if (c==_T('-') || (c>=_T('0') && c<=_T('9')))	{sax->state=sax_number;ok=sax_append(sax,&c,1);}
+				else if (c>=_T('a') && c<=_T('z'))	{sax->state=sax_literal;ok=sax_append(sax,&c,1);}
+				else ok=0;
+				break;
+			case sax_key: case sax_first_key:
+				if (c==_T('\"'))	{sax->is_key=1;sax->state=sax_string;sax->escaped=0;ok=sax_append(sax,&c,1);}
+				else if (c==_T('}') && sax->state==sax_first_key) ok=sax_pop(sax,'{');
+				else ok=0;
+				break;
+			case sax_colon:
+				if (c==_T(':')) sax->state=sax_value;
+				else ok=0;
+				break;
+			case sax_after:
+				if (c==_T(','))			sax->state=(sax->stack[sax->depth-1]=='{')?sax_key:sax_value;
+				else if (c==_T(']'))	ok=sax_pop(sax,'[');
+				else if (c==_T('}'))	ok=sax_pop(sax,'{');
+				else ok=0;
+				break;
+		}
+		if (ok) i++;
+	}
+	sax->offset+=i;
+	if (!ok) sax->state=sax_failed;
+	return ok;
+}
+
+int cJSON_FinishSAXParser(cJSON_SAXParser *sax)
+{
+	if (!sax || sax->state==sax_failed) return 0;
+	if ((sax->state==sax_number || sax->state==sax_literal) && !sax_emit(sax)) {sax->state=sax_failed;return 0;}
+	if (sax->state!=sax_value || sax->depth) {sax->state=sax_failed;return 0;}	/* stopped inside a value. */
+	return 1;
+}
+
+/* Compact documents: 16-byte nodes in one array, linked by 32-bit indices. Names are kept in a node just before
+their value, and strings short enough to fit live in the node itself; the rest come from an arena. Node 0 stands for none. */
+#define COMPACT_TYPE 7			/* type bits of head: a cJSON type, or COMPACT_NAME. */
+#define COMPACT_NAME 7			/* the name of the member in the next node. */
+#define COMPACT_MEMBER 8		/* an object member: the node before holds its name. */
+#define COMPACT_INLINE 16		/* the string is stored in the node. */
+#define COMPACT_SHORT (sizeof(double)/sizeof(PFCHAR))	/* PFCHARs that fit in a node, terminator included. */
+typedef struct {
+	unsigned int head;			/* type and flags, as above. */
+	unsigned int next;			/* next sibling. */
+	union {double number;struct {unsigned int child,count;} list;const PFCHAR *string;PFCHAR text[COMPACT_SHORT];} u;
+} compact_node;
+struct cJSON_Compact {compact_node *nodes;unsigned int count,capacity;cJSON_Arena *strings;cJSON_Hooks hooks;};
+
+/* Append a zeroed node, growing the array geometrically. Returns its index, or 0 on memory failure. */
+static unsigned int compact_add(cJSON_Compact *doc,unsigned int head)
+{
+	compact_node *grown;unsigned int size;
+	if (doc->count==doc->capacity)
+	{
+		size=doc->capacity?doc->capacity*2:64;
+		if (size<=doc->capacity || size>((size_t)-1)/sizeof(compact_node)) return 0;
+		if (!(grown=(compact_node*)doc->hooks.malloc_fn(size*sizeof(compact_node)))) return 0;
+		if (doc->nodes) {memcpy(grown,doc->nodes,doc->count*sizeof(compact_node));doc->hooks.free_fn(doc->nodes);}
+		doc->nodes=grown;doc->capacity=size;
+	}
+	memset(&doc->nodes[doc->count],0,sizeof(compact_node));
+	doc->nodes[doc->count].head=head;
+	return doc->count++;
+}
+
+/* Unescape the string at str into the arena, then move it into the node if it is short enough. */
+static const PFCHAR *compact_string(cJSON_Compact *doc,unsigned int node,const PFCHAR *str,parse_state *ps)
+{
+	cJSON tmp;arena_chunk *chunk=ps->arena->current;size_t used=chunk?chunk->used:0,len;
+	if (!(str=parse_string(&tmp,str,ps))) return 0;
+	len=strlen(tmp.valuestring);
+	if (len<COMPACT_SHORT)
+	{
+		memcpy(doc->nodes[node].u.text,tmp.valuestring,(len+1)*sizeof(PFCHAR));
+		doc->nodes[node].head|=COMPACT_INLINE;
+		arena_rewind(ps->arena,chunk,used);
+	}
+	else doc->nodes[node].u.string=tmp.valuestring;
+	return str;
+}
+
+/* Parse a value into a new node (flagged with member), in the same way as parse_value. */
+static const PFCHAR *compact_value(cJSON_Compact *doc,unsigned int member,const PFCHAR *value,parse_state *ps,unsigned int *out)
+{
+	unsigned int node,name,child,prev=0;PFCHAR close;cJSON tmp;
+	if (!value)						return 0;	/* Fail on null. */
+	if (value>=ps->end)				{ps->ep=value;return 0;}	/* out of input. */
+	if (!(*out=node=compact_add(doc,member))) return 0;	/* memory fail */
+	if (ps->end-value>=4 && !strncmp(value,_T("null"),4))	{ doc->nodes[node].head|=cJSON_NULL;  return value+4; }
+	if (ps->end-value>=5 && !strncmp(value,_T("false"),5))	{ doc->nodes[node].head|=cJSON_False; return value+5; }
+	if (ps->end-value>=4 && !strncmp(value,_T("true"),4))	{ doc->nodes[node].head|=cJSON_True;  return value+4; }
+	if (*value==_T('\"'))			{ doc->nodes[node].head|=cJSON_String; return compact_string(doc,node,value,ps); }
+	if (*value==_T('-') || (*value>=_T('0') && *value<=_T('9')))
 	{
-		case cJSON_NULL:	out=cJSON_strdup(_T("null"));	break;
-		case cJSON_False:	out=cJSON_strdup(_T("false"));break;
-		case cJSON_True:	out=cJSON_strdup(_T("true")); break;
-		case cJSON_Number:	out=print_number(item);break;
-		case cJSON_String:	out=print_string(item);break;
-		case cJSON_Array:	out=print_array(item,depth,fmt);break;
-		case cJSON_Object:	out=print_object(item,depth,fmt);break;
+		doc->nodes[node].head|=cJSON_Number;
+		if ((value=parse_number(&tmp,value,ps))) doc->nodes[node].u.number=tmp.valuedouble;
+		return value;
 	}
-	return out;
+	if (*value!=_T('[') && *value!=_T('{'))	{ps->ep=value;return 0;}	/* failure. */
+
+	if (ps->depth>=ps->max_depth) {ps->ep=value;return 0;}	/* nested too deep. */
+	doc->nodes[node].head|=(*value==_T('{'))?cJSON_Object:cJSON_Array;
+	close=(*value==_T('{'))?_T('}'):_T(']');
+	value=skip(value+1,ps);
+	if (value<ps->end && *value==close) return value+1;	/* empty. */
+	ps->depth++;
+	for (;;)
+	{
+		if (close==_T('}'))
+		{
+			if (!(name=compact_add(doc,COMPACT_NAME))) return 0;
+			value=skip(compact_string(doc,name,skip(value,ps),ps),ps);
+			if (!value) return 0;
+			if (value>=ps->end || *value!=_T(':')) {ps->ep=value;return 0;}	/* fail! */
+			value=skip(compact_value(doc,COMPACT_MEMBER,skip(value+1,ps),ps,&child),ps);	/* lands on name+1. */
+		}
+		else value=skip(compact_value(doc,0,skip(value,ps),ps,&child),ps);
+		if (!value) return 0;
+		if (prev) doc->nodes[prev].next=child; else doc->nodes[node].u.list.child=child;
+		doc->nodes[node].u.list.count++;prev=child;
+		if (value<ps->end && *value==_T(',')) value++;
+		else if (value<ps->end && *value==close) {ps->depth--;return value+1;}
+		else {ps->ep=value;return 0;}	/* malformed. */
+	}
+}
+
+cJSON_Compact *cJSON_ParseCompactWithLength(const PFCHAR *value,size_t length)
+{
+	parse_state ps;cJSON_Compact *doc;compact_node *trimmed;unsigned int root;
+	parse_init(&ps,0);ps.end=value?value+length:0;
+	ep=0;
+	if (!(doc=(cJSON_Compact*)ps.hooks.malloc_fn(sizeof(cJSON_Compact)))) return 0;
+	memset(doc,0,sizeof(cJSON_Compact));
+	doc->hooks=ps.hooks;
+	ps.arena=doc->strings=cJSON_CreateArena((length<8192)?1024:(length<524288)?length/8:65536,&ps.hooks);	/* strings take a fraction of the text. */
+	if (ps.arena) compact_add(doc,0);	/* node 0 stands for none. */
+	if (!doc->count || !compact_value(doc,0,skip(value,&ps),&ps,&root)) {ep=ps.ep;cJSON_DeleteCompact(doc);return 0;}
+	/* Give back the slack left by doubling; keep it if the copy can't be had. */
+	if (doc->capacity-doc->count>doc->count/8 && (trimmed=(compact_node*)doc->hooks.malloc_fn(doc->count*sizeof(compact_node))))
+	{
+		memcpy(trimmed,doc->nodes,doc->count*sizeof(compact_node));doc->hooks.free_fn(doc->nodes);
+		doc->nodes=trimmed;doc->capacity=doc->count;
+	}
+	return doc;
 }
+cJSON_Compact *cJSON_ParseCompact(const PFCHAR *value)	{return cJSON_ParseCompactWithLength(value,value?strlen(value):0);}
 
-/* Build an array from input text. */
-static const PFCHAR *parse_array(cJSON *item,const PFCHAR *value)
+void cJSON_DeleteCompact(cJSON_Compact *doc)
 {
-	cJSON *child;
-	if (*value!=_T('['))	{ep=value;return 0;}	/* not an array! */
+	if (!doc) return;
+	cJSON_DeleteArena(doc->strings);
+	doc->hooks.free_fn(doc->nodes);
+	doc->hooks.free_fn(doc);
+}
 
-	item->type=cJSON_Array;
-	value=skip(value+1);
-	if (*value==_T(']')) return value+1;	/* empty array. */
+size_t cJSON_GetCompactMemory(cJSON_Compact *doc)
+{
+	size_t bytes;arena_chunk *c;
+	if (!doc) return 0;
+	bytes=sizeof(cJSON_Compact)+sizeof(cJSON_Arena)+doc->capacity*sizeof(compact_node);
+	for (c=doc->strings->head;c;c=c->next) bytes+=ARENA_HEADER+c->size;
+	return bytes;
+}
 
-	item->child=child=cJSON_New_Item();
-	if (!item->child) return 0;		 /* memory fail */
-	value=skip(parse_value(child,skip(value)));	/* skip any spacing, get the value. */
-	if (!value) return 0;
+/* Accessors. Every one takes node 0 (none) quietly, so calls can be chained. */
+static compact_node *compact_get(cJSON_Compact *doc,cJSON_Node node)	{return (doc && node && node<doc->count)?&doc->nodes[node]:0;}
+static const PFCHAR *compact_text(compact_node *n)	{return (n->head&COMPACT_INLINE)?n->u.text:n->u.string;}
 
-	while (*value==_T(','))
+cJSON_Node cJSON_GetCompactRoot(cJSON_Compact *doc)	{return (doc && doc->count>1)?1:0;}
+int    cJSON_GetCompactType(cJSON_Compact *doc,cJSON_Node node)		{compact_node *n=compact_get(doc,node);return n?(int)(n->head&COMPACT_TYPE):-1;}
+double cJSON_GetCompactNumber(cJSON_Compact *doc,cJSON_Node node)	{compact_node *n=compact_get(doc,node);return (n && (n->head&COMPACT_TYPE)==cJSON_Number)?n->u.number:0;}
+const PFCHAR *cJSON_GetCompactString(cJSON_Compact *doc,cJSON_Node node)	{compact_node *n=compact_get(doc,node);return (n && (n->head&COMPACT_TYPE)==cJSON_String)?compact_text(n):0;}
+const PFCHAR *cJSON_GetCompactName(cJSON_Compact *doc,cJSON_Node node)		{compact_node *n=compact_get(doc,node);return (n && (n->head&COMPACT_MEMBER))?compact_text(n-1):0;}
+int    cJSON_GetCompactSize(cJSON_Compact *doc,cJSON_Node node)
+{
+	compact_node *n=compact_get(doc,node);
+	return (n && ((n->head&COMPACT_TYPE)==cJSON_Array || (n->head&COMPACT_TYPE)==cJSON_Object))?(int)n->u.list.count:0;
+}
+cJSON_Node cJSON_GetCompactChild(cJSON_Compact *doc,cJSON_Node node)	{return cJSON_GetCompactSize(doc,node)?doc->nodes[node].u.list.child:0;}
+cJSON_Node cJSON_GetCompactNext(cJSON_Compact *doc,cJSON_Node node)		{compact_node *n=compact_get(doc,node);return n?n->next:0;}
+cJSON_Node cJSON_GetCompactArrayItem(cJSON_Compact *doc,cJSON_Node node,int item)
+{
+	cJSON_Node c=cJSON_GetCompactChild(doc,node);
+	while (c && item>0) item--,c=doc->nodes[c].next;
+	return item?0:c;
+}
+cJSON_Node cJSON_GetCompactObjectItem(cJSON_Compact *doc,cJSON_Node node,const PFCHAR *string)
+{
+	cJSON_Node c=(cJSON_GetCompactType(doc,node)==cJSON_Object)?cJSON_GetCompactChild(doc,node):0;
+	while (c && cJSON_strcasecmp(compact_text(&doc->nodes[c-1]),string)) c=doc->nodes[c].next;
+	return c;
+}
+
+cJSON *cJSON_ExpandCompact(cJSON_Compact *doc,cJSON_Node node)
+{
+	compact_node *n=compact_get(doc,node);cJSON *item=0,*child;cJSON_Node c;
+	if (!n) return 0;
+	switch (n->head&COMPACT_TYPE)
+	{
+		case cJSON_NULL:	return cJSON_CreateNull();
+		case cJSON_False:	return cJSON_CreateFalse();
+		case cJSON_True:	return cJSON_CreateTrue();
+		case cJSON_Number:	return cJSON_CreateNumber(n->u.number);
+		case cJSON_String:	return cJSON_CreateString(compact_text(n));
+		case cJSON_Array:	item=cJSON_CreateArray();break;
+		case cJSON_Object:	item=cJSON_CreateObject();break;
+		default:			return 0;
+	}
+	for (c=n->u.list.child;item && c;c=doc->nodes[c].next)
 	{
-		cJSON *new_item;
-		if (!(new_item=cJSON_New_Item())) return 0; 	/* memory fail */
-		child->next=new_item;new_item->prev=child;child=new_item;
-		value=skip(parse_value(child,skip(value+1)));
-		if (!value) return 0;	/* memory fail */
+		if (!(child=cJSON_ExpandCompact(doc,c))) {cJSON_Delete(item);return 0;}
+		if (doc->nodes[c].head&COMPACT_MEMBER) cJSON_AddItemToObject(item,compact_text(&doc->nodes[c-1]),child);
+		else cJSON_AddItemToArray(item,child);
 	}
+	return item;
+}
 
-	if (*value==_T(']')) return value+1;	/* end of array */
-	ep=value;return 0;	/* malformed. */
+/* Tapes: the document flattened into 8-byte entries in text order, with the strings in one side buffer. A container
+entry holds the position of its end entry (and the end entry points back), so a whole subtree is skipped in one step;
+an object member is a name entry followed by the value, and a number's double takes the entry after it. Entry 0 stands for none. */
+#define TAPE_TYPE 15			/* tag bits of head: a cJSON type, TAPE_NAME or TAPE_END. */
+#define TAPE_NAME 7
+#define TAPE_END 8
+#define TAPE_MEMBER 16			/* a value preceded by its name. */
+#define TAPE_COUNT_SHIFT 8		/* containers keep their size in the top bits of head, saturating. */
+#define TAPE_COUNT_MAX (0xFFFFFFu)
+typedef union {struct {unsigned int head,payload;} e;double number;} tape_entry;
+struct cJSON_Tape {tape_entry *entries;unsigned int count,capacity;PFCHAR *strings;size_t used,size;cJSON_Hooks hooks;};
+
+/* Append an entry, growing the tape geometrically. Returns its position, or 0 on memory failure. */
+static unsigned int tape_add(cJSON_Tape *tape,unsigned int head,unsigned int payload)
+{
+	tape_entry *grown;unsigned int size;
+	if (tape->count==tape->capacity)
+	{
+		size=tape->capacity?tape->capacity*2:64;
+		if (size<=tape->capacity || size>((size_t)-1)/sizeof(tape_entry)) return 0;
+		if (!(grown=(tape_entry*)tape->hooks.malloc_fn(size*sizeof(tape_entry)))) return 0;
+		if (tape->entries) {memcpy(grown,tape->entries,tape->count*sizeof(tape_entry));tape->hooks.free_fn(tape->entries);}
+		tape->entries=grown;tape->capacity=size;
+	}
+	tape->entries[tape->count].e.head=head;tape->entries[tape->count].e.payload=payload;
+	return tape->count++;
 }
 
-/* Render an array to text */
-static PFCHAR *print_array(cJSON *item,int depth,int fmt)
+/* Unescape the string at str, copy it to the side buffer and add an entry pointing at it. */
+static const PFCHAR *tape_string(cJSON_Tape *tape,unsigned int head,const PFCHAR *str,parse_state *ps)
 {
-	PFCHAR **entries;
-	PFCHAR *out=0,*ptr,*ret;int len=5;
-	cJSON *child=item->child;
-	int numentries=0,i=0,fail=0;
-	
-	/* How many entries in the array? */
-	while (child) numentries++,child=child->next;
-	/* Explicitly handle numentries==0 */
-	if (!numentries)
-	{
-		out=(PFCHAR*)cJSON_malloc(3*sizeof(PFCHAR));
-		if (out) strcpy(out,_T("[]"));
-		return out;
-	}
-	/* Allocate an array to hold the values for each */
-	entries=(PFCHAR**)cJSON_malloc(numentries*sizeof(PFCHAR*));
-	if (!entries) return 0;
-	memset(entries,0,numentries*sizeof(PFCHAR*));
-	/* Retrieve all the results: */
-	child=item->child;
-	while (child && !fail)
-	{
-		ret=print_value(child,depth+1,fmt);
-		entries[i++]=ret;
-		if (ret) len+=strlen(ret)+2+(fmt?1:0); else fail=1;
-		child=child->next;
+	cJSON tmp;PFCHAR *grown;size_t len,size;
+	if (!(str=parse_string(&tmp,str,ps))) return 0;
+	len=strlen(tmp.valuestring)+1;
+	if (tape->used+len>tape->size)
+	{
+		for (size=tape->size?tape->size*2:256;size<tape->used+len;size*=2);
+		if (size>0xFFFFFFFFu || !(grown=(PFCHAR*)tape->hooks.malloc_fn(size*sizeof(PFCHAR)))) return 0;	/* offsets are 32 bits. */
+		if (tape->strings) {memcpy(grown,tape->strings,tape->used*sizeof(PFCHAR));tape->hooks.free_fn(tape->strings);}
+		tape->strings=grown;tape->size=size;
 	}
-	
-	/* If we didn't fail, try to malloc the output string */
-	if (!fail) out=(PFCHAR*)cJSON_malloc(len*sizeof(PFCHAR));
-	/* If that fails, we fail. */
-	if (!out) fail=1;
+	if (!tape_add(tape,head,(unsigned int)tape->used)) return 0;
+	memcpy(tape->strings+tape->used,tmp.valuestring,len*sizeof(PFCHAR));
+	tape->used+=len;
+	cJSON_ResetArena(ps->arena);	/* the arena only held this string. */
+	return str;
+}
 
-	/* Handle failure. */
-	if (fail)
+/* Parse a value onto the tape (flagged with member), in the same way as parse_value. */
+static const PFCHAR *tape_value(cJSON_Tape *tape,unsigned int member,const PFCHAR *value,parse_state *ps)
+{
+	unsigned int at,end,count=0;PFCHAR close;cJSON tmp;
+	if (!value)						return 0;	/* Fail on null. */
+	if (value>=ps->end)				{ps->ep=value;return 0;}	/* out of input. */
+	if (ps->end-value>=4 && !strncmp(value,_T("null"),4))	return tape_add(tape,cJSON_NULL|member,0)?value+4:0;
+	if (ps->end-value>=5 && !strncmp(value,_T("false"),5))	return tape_add(tape,cJSON_False|member,0)?value+5:0;
+	if (ps->end-value>=4 && !strncmp(value,_T("true"),4))	return tape_add(tape,cJSON_True|member,0)?value+4:0;
+	if (*value==_T('\"'))			return tape_string(tape,cJSON_String|member,value,ps);
+	if (*value==_T('-') || (*value>=_T('0') && *value<=_T('9')))
 	{
-		for (i=0;i<numentries;i++) if (entries[i]) cJSON_free(entries[i]);
-		cJSON_free(entries);
-		return 0;
+		if (!(value=parse_number(&tmp,value,ps))) return 0;
+		if (!(at=tape_add(tape,cJSON_Number|member,0)) || !tape_add(tape,0,0)) return 0;
+		tape->entries[at+1].number=tmp.valuedouble;
+		return value;
 	}
-	
-	/* Compose the output array. */
-	*out=_T('[');
-	ptr=out+1;*ptr=0;
-	for (i=0;i<numentries;i++)
+	if (*value!=_T('[') && *value!=_T('{'))	{ps->ep=value;return 0;}	/* failure. */
+
+	if (ps->depth>=ps->max_depth) {ps->ep=value;return 0;}	/* nested too deep. */
+	close=(*value==_T('{'))?_T('}'):_T(']');
+	if (!(at=tape_add(tape,((close==_T('}'))?cJSON_Object:cJSON_Array)|member,0))) return 0;
+	value=skip(value+1,ps);
+	ps->depth++;
+	if (value>=ps->end || *value!=close) for (;;)
 	{
-		strcpy(ptr,entries[i]);ptr+=strlen(entries[i]);
-		if (i!=numentries-1) {*ptr++=_T(',');if(fmt)*ptr++=_T(' ');*ptr=0;}
-		cJSON_free(entries[i]);
+		if (close==_T('}'))
+		{
+			value=skip(tape_string(tape,TAPE_NAME,skip(value,ps),ps),ps);
+			if (!value) return 0;
+			if (value>=ps->end || *value!=_T(':')) {ps->ep=value;return 0;}	/* fail! */
+			value=skip(tape_value(tape,TAPE_MEMBER,skip(value+1,ps),ps),ps);
+		}
+		else value=skip(tape_value(tape,0,skip(value,ps),ps),ps);
+		if (!value) return 0;
+		count++;
+		if (value<ps->end && *value==_T(',')) value++;
+		else if (value<ps->end && *value==close) break;
+		else {ps->ep=value;return 0;}	/* malformed. */
 	}
-	cJSON_free(entries);
-	*ptr++=_T(']');*ptr++=0;
-	return out;	
+	ps->depth--;
+	if (!(end=tape_add(tape,TAPE_END,at))) return 0;
+	tape->entries[at].e.payload=end;
+	tape->entries[at].e.head|=((count<TAPE_COUNT_MAX)?count:TAPE_COUNT_MAX)<<TAPE_COUNT_SHIFT;
+	return value+1;
 }
 
-/* Build an object from the text. */
-static const PFCHAR *parse_object(cJSON *item,const PFCHAR *value)
+cJSON_Tape *cJSON_ParseTapeWithLength(const PFCHAR *value,size_t length)
 {
-	cJSON *child;
-	if (*value!=_T('{'))	{ep=value;return 0;}	/* not an object! */
-	
-	item->type=cJSON_Object;
-	value=skip(value+1);
-	if (*value==_T('}')) return value+1;	/* empty array. */
-	
-	item->child=child=cJSON_New_Item();
-	if (!item->child) return 0;
-	value=skip(parse_string(child,skip(value)));
-	if (!value) return 0;
-	child->string=child->valuestring;child->valuestring=0;
-	if (*value!=_T(':')) {ep=value;return 0;}	/* fail! */
-	value=skip(parse_value(child,skip(value+1)));	/* skip any spacing, get the value. */
-	if (!value) return 0;
-	
-	while (*value==_T(','))
+	parse_state ps;cJSON_Tape *tape;tape_entry *trimmed;PFCHAR *strings;
+	parse_init(&ps,0);ps.end=value?value+length:0;
+	ep=0;
+	if (!(tape=(cJSON_Tape*)ps.hooks.malloc_fn(sizeof(cJSON_Tape)))) return 0;
+	memset(tape,0,sizeof(cJSON_Tape));
+	tape->hooks=ps.hooks;
+	ps.arena=cJSON_CreateArena(0,&ps.hooks);	/* scratch for unescaping. */
+	if (ps.arena) tape_add(tape,0,0);	/* entry 0 stands for none. */
+	if (!tape->count || !tape_value(tape,0,skip(value,&ps),&ps)) {ep=ps.ep;cJSON_DeleteArena(ps.arena);cJSON_DeleteTape(tape);return 0;}
+	cJSON_DeleteArena(ps.arena);
+	/* Give back the slack left by doubling; keep it if the copy can't be had. */
+	if (tape->capacity-tape->count>tape->count/8 && (trimmed=(tape_entry*)tape->hooks.malloc_fn(tape->count*sizeof(tape_entry))))
 	{
-		cJSON *new_item;
-		if (!(new_item=cJSON_New_Item()))	return 0; /* memory fail */
-		child->next=new_item;new_item->prev=child;child=new_item;
-		value=skip(parse_string(child,skip(value+1)));
-		if (!value) return 0;
-		child->string=child->valuestring;child->valuestring=0;
-		if (*value!=_T(':')) {ep=value;return 0;}	/* fail! */
-		value=skip(parse_value(child,skip(value+1)));	/* skip any spacing, get the value. */
-		if (!value) return 0;
+		memcpy(trimmed,tape->entries,tape->count*sizeof(tape_entry));tape->hooks.free_fn(tape->entries);
+		tape->entries=trimmed;tape->capacity=tape->count;
 	}
-	
-	if (*value==_T('}')) return value+1;	/* end of array */
-	ep=value;return 0;	/* malformed. */
-}
-
-/* Render an object to text. */
-static PFCHAR *print_object(cJSON *item,int depth,int fmt)
-{
-	PFCHAR **entries=0,**names=0;
-	PFCHAR *out=0,*ptr,*ret,*str;int len=7,i=0,j;
-	cJSON *child=item->child;
-	int numentries=0,fail=0;
-	/* Count the number of entries. */
-	while (child) numentries++,child=child->next;
-	/* Explicitly handle empty object case */
-	if (!numentries)
-	{
-		out=(PFCHAR*)cJSON_malloc((fmt?depth+4:3)*sizeof(PFCHAR));
-		if (!out)	return 0;
-		ptr=out;*ptr++=_T('{');
-		if (fmt) {*ptr++=_T('\n');for (i=0;i<depth-1;i++) *ptr++=_T('\t');}
-		*ptr++=_T('}');*ptr++=0;
-		return out;
-	}
-	/* Allocate space for the names and the objects */
-	entries=(PFCHAR**)cJSON_malloc(numentries*sizeof(PFCHAR*));
-	if (!entries) return 0;
-	names=(PFCHAR**)cJSON_malloc(numentries*sizeof(PFCHAR*));
-	if (!names) {cJSON_free(entries);return 0;}
-	memset(entries,0,sizeof(PFCHAR*)*numentries);
-	memset(names,0,sizeof(PFCHAR*)*numentries);
-
-	/* Collect all the results into our arrays: */
-	child=item->child;depth++;if (fmt) len+=depth;
-	while (child&&!fail)
-	{
-		names[i]=str=print_string_ptr(child->string);
-		entries[i++]=ret=print_value(child,depth,fmt);
-		if (str && ret) len+=strlen(ret)+strlen(str)+2+(fmt?2+depth:0); else fail=1;
-		child=child->next;
+	if (tape->size-tape->used>tape->used/8 && (strings=(PFCHAR*)tape->hooks.malloc_fn(tape->used*sizeof(PFCHAR))))
+	{
+		memcpy(strings,tape->strings,tape->used*sizeof(PFCHAR));tape->hooks.free_fn(tape->strings);
+		tape->strings=strings;tape->size=tape->used;
 	}
-	
-	/* Try to allocate the output string */
-	if (!fail) out=(PFCHAR*)cJSON_malloc(len*sizeof(PFCHAR));
-	if (!out) fail=1;
+	return tape;
+}
+cJSON_Tape *cJSON_ParseTape(const PFCHAR *value)	{return cJSON_ParseTapeWithLength(value,value?strlen(value):0);}
+
+void cJSON_DeleteTape(cJSON_Tape *tape)
+{
+	if (!tape) return;
+	tape->hooks.free_fn(tape->entries);
+	tape->hooks.free_fn(tape->strings);
+	tape->hooks.free_fn(tape);
+}
+
+/* Navigation. Every call takes position 0 (none) quietly, so calls can be chained. */
+static tape_entry *tape_get(cJSON_Tape *tape,cJSON_Node node)	{return (tape && node && node<tape->count)?&tape->entries[node]:0;}
+static int tape_is_list(tape_entry *t)	{return t && ((t->e.head&TAPE_TYPE)==cJSON_Array || (t->e.head&TAPE_TYPE)==cJSON_Object);}
+
+size_t cJSON_GetTapeMemory(cJSON_Tape *tape)	{return tape?sizeof(cJSON_Tape)+tape->capacity*sizeof(tape_entry)+tape->size*sizeof(PFCHAR):0;}
+cJSON_Node cJSON_GetTapeRoot(cJSON_Tape *tape)	{return (tape && tape->count>1)?1:0;}
+int    cJSON_GetTapeType(cJSON_Tape *tape,cJSON_Node node)		{tape_entry *t=tape_get(tape,node);return t?(int)(t->e.head&TAPE_TYPE):-1;}
+double cJSON_GetTapeNumber(cJSON_Tape *tape,cJSON_Node node)	{tape_entry *t=tape_get(tape,node);return (t && (t->e.head&TAPE_TYPE)==cJSON_Number)?t[1].number:0;}
+const PFCHAR *cJSON_GetTapeString(cJSON_Tape *tape,cJSON_Node node)	{tape_entry *t=tape_get(tape,node);return (t && (t->e.head&TAPE_TYPE)==cJSON_String)?tape->strings+t->e.payload:0;}
+const PFCHAR *cJSON_GetTapeName(cJSON_Tape *tape,cJSON_Node node)		{tape_entry *t=tape_get(tape,node);return (t && (t->e.head&TAPE_MEMBER))?tape->strings+t[-1].e.payload:0;}
+
+cJSON_Node cJSON_GetTapeChild(cJSON_Tape *tape,cJSON_Node node)
+{
+	tape_entry *t=tape_get(tape,node);
+	if (!tape_is_list(t) || t->e.payload==node+1) return 0;	/* not a container, or empty. */
+	return ((t->e.head&TAPE_TYPE)==cJSON_Object)?node+2:node+1;	/* step over the first name. */
+}
+cJSON_Node cJSON_GetTapeNext(cJSON_Tape *tape,cJSON_Node node)
+{
+	tape_entry *t=tape_get(tape,node);
+	if (!t) return 0;
+	node=tape_is_list(t)?t->e.payload+1:((t->e.head&TAPE_TYPE)==cJSON_Number)?node+2:node+1;	/* skip the subtree. */
+	if (node>=tape->count || (tape->entries[node].e.head&TAPE_TYPE)==TAPE_END) return 0;
+	return ((tape->entries[node].e.head&TAPE_TYPE)==TAPE_NAME)?node+1:node;
+}
+int    cJSON_GetTapeSize(cJSON_Tape *tape,cJSON_Node node)
+{
+	tape_entry *t=tape_get(tape,node);int i=0;cJSON_Node c;
+	if (!tape_is_list(t)) return 0;
+	if ((t->e.head>>TAPE_COUNT_SHIFT)<TAPE_COUNT_MAX) return (int)(t->e.head>>TAPE_COUNT_SHIFT);
+	for (c=cJSON_GetTapeChild(tape,node);c;c=cJSON_GetTapeNext(tape,c)) i++;	/* too many to have kept count. */
+	return i;
+}
+cJSON_Node cJSON_GetTapeArrayItem(cJSON_Tape *tape,cJSON_Node node,int item)
+{
+	cJSON_Node c=cJSON_GetTapeChild(tape,node);
+	while (c && item>0) item--,c=cJSON_GetTapeNext(tape,c);
+	return item?0:c;
+}
+cJSON_Node cJSON_GetTapeObjectItem(cJSON_Tape *tape,cJSON_Node node,const PFCHAR *string)
+{
+	cJSON_Node c=(cJSON_GetTapeType(tape,node)==cJSON_Object)?cJSON_GetTapeChild(tape,node):0;
+	while (c && cJSON_strcasecmp(tape->strings+tape->entries[c-1].e.payload,string)) c=cJSON_GetTapeNext(tape,c);
+	return c;
+}
 
-	/* Handle failure */
-	if (fail)
+cJSON *cJSON_ExpandTape(cJSON_Tape *tape,cJSON_Node node)
+{
+	cJSON *item=0,*child;cJSON_Node c;
+	switch (cJSON_GetTapeType(tape,node))
 	{
-		for (i=0;i<numentries;i++) {if (names[i]) cJSON_free(names[i]);if (entries[i]) cJSON_free(entries[i]);}
-		cJSON_free(names);cJSON_free(entries);
-		return 0;
+		case cJSON_NULL:	return cJSON_CreateNull();
+		case cJSON_False:	return cJSON_CreateFalse();
+		case cJSON_True:	return cJSON_CreateTrue();
+		case cJSON_Number:	return cJSON_CreateNumber(cJSON_GetTapeNumber(tape,node));
+		case cJSON_String:	return cJSON_CreateString(cJSON_GetTapeString(tape,node));
+		case cJSON_Array:	item=cJSON_CreateArray();break;
+		case cJSON_Object:	item=cJSON_CreateObject();break;
+		default:			return 0;
 	}
-	
-	/* Compose the output: */
-	*out=_T('{');ptr=out+1;if (fmt)*ptr++=_T('\n');*ptr=0;
-	for (i=0;i<numentries;i++)
-	{
-		if (fmt) for (j=0;j<depth;j++) *ptr++=_T('\t');
-		strcpy(ptr,names[i]);ptr+=strlen(names[i]);
-		*ptr++=_T(':');if (fmt) *ptr++=_T('\t');
-		strcpy(ptr,entries[i]);ptr+=strlen(entries[i]);
-		if (i!=numentries-1) *ptr++=_T(',');
-		if (fmt) *ptr++=_T('\n');*ptr=0;
-		cJSON_free(names[i]);cJSON_free(entries[i]);
+	for (c=cJSON_GetTapeChild(tape,node);item && c;c=cJSON_GetTapeNext(tape,c))
+	{
+		if (!(child=cJSON_ExpandTape(tape,c))) {cJSON_Delete(item);return 0;}
+		if ((item->type&255)==cJSON_Object) cJSON_AddItemToObject(item,cJSON_GetTapeName(tape,c),child);
+		else cJSON_AddItemToArray(item,child);
 	}
-	
-	cJSON_free(names);cJSON_free(entries);
-	if (fmt) for (i=0;i<depth-1;i++) *ptr++=_T('\t');
-	*ptr++=_T('}');*ptr++=0;
-	return out;	
+	return item;
+}
+
+/* Parse the children of a lazily parsed array or object, leaving theirs for later. If the text turns out to be
+malformed this returns 0 with the error pointer set, and the item stays as it was. */
+static int expand(cJSON *item)
+{
+	parse_state ps;const PFCHAR *start;int type,length;
+	if (!item || !(item->type&cJSON_IsLazy)) return 1;
+	type=item->type;start=item->valuestring;length=item->valueint;
+	parse_init(&ps,0);ps.lazy=1;ps.end=start+length;
+	item->valuestring=0;item->valueint=0;
+	if (((type&255)==cJSON_Array?parse_array(item,start,&ps):parse_object(item,start,&ps))==ps.end)
+	{
+		item->type=type&~cJSON_IsLazy;
+		return 1;
+	}
+	delete_item(item->child,&ps.hooks);item->child=0;
+	item->type=type;item->valuestring=(PFCHAR*)start;item->valueint=length;
+	ep=ps.ep?ps.ep:start;
+	return 0;
 }
 
 /* Get Array size/item / object item. */
-int    cJSON_GetArraySize(cJSON *array)							{cJSON *c=array->child;int i=0;while(c)i++,c=c->next;return i;}
-cJSON *cJSON_GetArrayItem(cJSON *array,int item)				{cJSON *c=array->child;  while (c && item>0) item--,c=c->next; return c;}
-cJSON *cJSON_GetObjectItem(cJSON *object,const PFCHAR *string)	{cJSON *c=object->child; while (c && cJSON_strcasecmp(c->string,string)) c=c->next; return c;}
+int    cJSON_GetArraySize(cJSON *array)
+{
+	cJSON *c;int i=0;
+	if (!expand(array)) return 0;
+	c=array->child;
+	if (array->index && (array->index->items || index_build_items(array))) return (int)array->index->count;
+	while(c)i++,c=c->next;
+	return i;
+}
+cJSON *cJSON_GetArrayItem(cJSON *array,int item)
+{
+	cJSON *c;
+	if (!expand(array)) return 0;
+	c=array->child;
+	if (array->index && (array->index->items || index_build_items(array)))
+	{
+		if (item<0) item=0;
+		return ((size_t)item<array->index->count)?array->index->items[item]:0;
+	}
+	while (c && item>0) item--,c=c->next;
+	return c;
+}
+cJSON *cJSON_GetObjectItem(cJSON *object,const PFCHAR *string)
+{
+	cJSON *c,**slot;
+	if (!expand(object)) return 0;
+	if (object->index && string)
+	{
+		slot=index_find(object,string,0);
+		if (slot || object->index->slots) return slot?*slot:0;	/* a failed rebuild falls back to walking. */
+	}
+	c=object->child; while (c && cJSON_strcasecmp(c->string,string)) c=c->next; return c;
+}
+cJSON *cJSON_GetObjectItemCaseSensitive(cJSON *object,const PFCHAR *string)
+{
+	cJSON *c,**slot;
+	if (!string) return cJSON_GetObjectItem(object,string);
+	if (!expand(object)) return 0;
+	if (object->index)
+	{
+		slot=index_find(object,string,1);
+		if (slot || object->index->slots) return slot?*slot:0;
+	}
+	c=object->child; while (c && (!c->string || strcmp(c->string,string))) c=c->next; return c;
+}
+
+/* JSON Pointers (RFC 6901): "/a/0/b" names member a, its element 0, and that one's member b; "" is the root itself.
+In a token, ~1 stands for '/' and ~0 for '~'. Member names match exactly. */
+
+/* Whether a pointer is well formed: empty, or tokens each after a '/', with every '~' escaping a 0 or 1. */
+static int pointer_valid(const PFCHAR *pointer)
+{
+	if (!pointer || (*pointer && *pointer!=_T('/'))) return 0;
+	for (;*pointer;pointer++) if (*pointer==_T('~') && pointer[1]!=_T('0') && pointer[1]!=_T('1')) return 0;
+	return 1;
+}
+
+/* The array index the token from tok to end spells, or -1 if it isn't one: digits without a leading zero. */
+static int pointer_index(const PFCHAR *tok,const PFCHAR *end)
+{
+	int n=0;
+	if (tok>=end || (*tok==_T('0') && end-tok>1)) return -1;
+	for (;tok<end;tok++)
+	{
+		if (*tok<_T('0') || *tok>_T('9') || n>(INT_MAX-9)/10) return -1;
+		n=n*10+(*tok-_T('0'));
+	}
+	return n;
+}
+
+/* Whether key is the token from tok to end, once unescaped. */
+static int pointer_matches(const PFCHAR *key,const PFCHAR *tok,const PFCHAR *end)
+{
+	PFCHAR c;
+	if (!key) return 0;
+	for (;tok<end;tok++,key++)
+	{
+		c=*tok;
+		if (c==_T('~')) c=(*++tok==_T('1'))?_T('/'):_T('~');
+		if (*key!=c) return 0;
+	}
+	return !*key;
+}
+
+cJSON *cJSON_GetPointer(cJSON *root,const PFCHAR *pointer)
+{
+	const PFCHAR *tok,*end;cJSON *c;int i;
+	if (!pointer_valid(pointer)) return 0;
+	for (tok=pointer;root && *tok;tok=end)
+	{
+		for (end=++tok;*end && *end!=_T('/');end++);
+		if ((root->type&255)==cJSON_Array) root=((i=pointer_index(tok,end))<0)?0:cJSON_GetArrayItem(root,i);
+		else if ((root->type&255)==cJSON_Object)
+		{
+			cJSON_ArrayForEach(c,root) if (pointer_matches(c->string,tok,end)) break;
+			root=c;
+		}
+		else root=0;
+	}
+	return root;
+}
+
+/* A compiled pointer: every token unescaped once, with the array index it spells (or -1), in one block. */
+typedef struct {const PFCHAR *key;size_t length;int index;} path_token;
+struct cJSON_Path {cJSON_Hooks hooks;int count;path_token *tokens;};
+
+cJSON_Path *cJSON_CompilePath(const PFCHAR *pointer,cJSON_Hooks *hooks)
+{
+	cJSON_Hooks h;cJSON_Path *path;path_token *token;PFCHAR *keys;const PFCHAR *ptr,*end;int count=0;
+	if (!pointer_valid(pointer)) return 0;
+	for (ptr=pointer;*ptr;ptr++) if (*ptr==_T('/')) count++;
+	get_hooks(&h,hooks);
+	/* The unescaped keys with their terminators take no more room than the pointer does. */
+	if (!(path=(cJSON_Path*)h.malloc_fn(ARENA_ALIGN(sizeof(cJSON_Path))+count*sizeof(path_token)+(strlen(pointer)+1)*sizeof(PFCHAR)))) return 0;
+	path->hooks=h;path->count=count;
+	path->tokens=(path_token*)((char*)path+ARENA_ALIGN(sizeof(cJSON_Path)));
+	keys=(PFCHAR*)(path->tokens+count);
+	for (ptr=pointer,token=path->tokens;*ptr;ptr=end,token++)
+	{
+		for (end=++ptr;*end && *end!=_T('/');end++);
+		token->key=keys;token->index=pointer_index(ptr,end);
+		for (;ptr<end;ptr++) *keys++=(*ptr!=_T('~'))?*ptr:(*++ptr==_T('1'))?_T('/'):_T('~');
+		token->length=keys-token->key;
+		*keys++=0;
+	}
+	return path;
+}
+void cJSON_DeletePath(cJSON_Path *path)	{if (path) path->hooks.free_fn(path);}
+
+cJSON *cJSON_EvaluatePath(cJSON_Path *path,cJSON *root)
+{
+	path_token *token,*last;
+	if (!path) return 0;
+	for (token=path->tokens,last=token+path->count;root && token<last;token++)
+	{
+		if ((root->type&255)==cJSON_Array) root=(token->index<0)?0:cJSON_GetArrayItem(root,token->index);
+		else if ((root->type&255)==cJSON_Object) root=cJSON_GetObjectItemCaseSensitive(root,token->key);
+		else root=0;
+	}
+	return root;
+}
+
+/* One past the value at ptr, found without parsing it: end if it never closes, ptr itself if there is none. */
+static const PFCHAR *skip_value(const PFCHAR *ptr,const PFCHAR *end)
+{
+	if (*ptr==_T('\"')) ptr=skip_string(ptr,end);
+	else if (*ptr==_T('[') || *ptr==_T('{')) ptr=skip_brackets(ptr,end);
+	else {while (ptr<end && (UPFCHAR)*ptr>32 && !strchr(_T(",:[]{}\""),*ptr)) ptr++; return ptr;}
+	return (ptr<end)?ptr+1:end;
+}
+
+/* Whether the member name opening at str is token's key: 1, 0, or -1 if it can't be read. A name without
+escapes is compared where it stands; one with them is decoded first. */
+static int path_key_matches(const PFCHAR *str,const path_token *token,parse_state *ps)
+{
+	size_t run=clean_run(str+1,ps->end,str);cJSON item;int match;
+	if (str+1+run<ps->end && str[1+run]==_T('\"')) return run==token->length && !memcmp(str+1,token->key,run*sizeof(PFCHAR));
+	memset(&item,0,sizeof(cJSON));
+	if (!parse_string(&item,str,ps)) return -1;
+	match=!strcmp(item.valuestring,token->key);
+	ps->hooks.free_fn(item.valuestring);
+	return match;
+}
+
+/* The value named by token inside the array or object at ptr, reached by scanning past the ones before it.
+0 if it isn't there, with ps->ep set as well if the text is malformed on the way. */
+static const PFCHAR *path_step(const PFCHAR *ptr,const path_token *token,parse_state *ps)
+{
+	const PFCHAR *next;int object,n,match;PFCHAR close;
+	if (ptr>=ps->end || (*ptr!=_T('[') && *ptr!=_T('{'))) return 0;	/* a scalar has nothing inside. */
+	object=(*ptr==_T('{'));close=object?_T('}'):_T(']');
+	if (!object && token->index<0) return 0;
+	ptr=skip(ptr+1,ps);
+	if (ptr<ps->end && *ptr==close) return 0;	/* empty. */
+	for (n=0;;n++)
+	{
+		if (object)
+		{
+			if (ptr>=ps->end || *ptr!=_T('\"') || (match=path_key_matches(ptr,token,ps))<0) {ps->ep=ptr;return 0;}
+			if ((ptr=skip_string(ptr,ps->end))>=ps->end) {ps->ep=ptr;return 0;}
+			ptr=skip(ptr+1,ps);
+			if (ptr>=ps->end || *ptr!=_T(':')) {ps->ep=ptr;return 0;}
+			ptr=skip(ptr+1,ps);
+		}
+		else match=(n==token->index);
+		if (match) return ptr;
+		if (ptr>=ps->end || (next=skip_value(ptr,ps->end))==ptr) {ps->ep=ptr;return 0;}
+		ptr=skip(next,ps);
+		if (ptr<ps->end && *ptr==_T(',')) ptr=skip(ptr+1,ps);
+		else if (ptr<ps->end && *ptr==close) return 0;	/* not there. */
+		else {ps->ep=ptr;return 0;}
+	}
+}
+
+cJSON *cJSON_ParseAtPathWithLength(cJSON_Path *path,const PFCHAR *value,size_t length)
+{
+	parse_state ps;const PFCHAR *ptr;int i;cJSON *c=0;
+	if (!path || !value) return 0;
+	parse_init(&ps,0);ps.end=value+length;
+	ptr=skip(value,&ps);
+	for (i=0;ptr && i<path->count;i++) ptr=path_step(ptr,&path->tokens[i],&ps);
+	if (ptr) c=parse_root(ptr,ps.end-ptr,0,0,&ps);
+	ep=ps.ep;
+	return c;
+}
+cJSON *cJSON_ParseAtPath(cJSON_Path *path,const PFCHAR *value) {return cJSON_ParseAtPathWithLength(path,value,value?strlen(value):0);}
+
+/* Projections: the member names of the pointers, merged into a trie. Node 0 is the document itself; a node's children
+are a chain of siblings, 0 ending it. A node that ends a pointer is whole: everything under it is kept. */
+typedef struct {path_token token;int child,next,whole;} projection_node;
+struct cJSON_Projection {
+	cJSON_Hooks hooks;
+	cJSON_Path **paths;int count;	/* the compiled pointers, which the tokens point into. */
+	projection_node *nodes;int used;
+};
+
+void cJSON_DeleteProjection(cJSON_Projection *proj)
+{
+	int i;
+	if (!proj) return;
+	for (i=0;i<proj->count;i++) cJSON_DeletePath(proj->paths[i]);
+	proj->hooks.free_fn(proj->paths);
+	if (proj->nodes) proj->hooks.free_fn(proj->nodes);
+	proj->hooks.free_fn(proj);
+}
+
+cJSON_Projection *cJSON_CompileProjection(const PFCHAR **pointers,int count,cJSON_Hooks *hooks)
+{
+	cJSON_Hooks h;cJSON_Projection *proj;path_token *token;int i,j,node,c,size=1;
+	if (count<0 || (count && !pointers)) return 0;
+	get_hooks(&h,hooks);
+	if (!(proj=(cJSON_Projection*)h.malloc_fn(sizeof(cJSON_Projection)))) return 0;
+	memset(proj,0,sizeof(cJSON_Projection));
+	proj->hooks=h;
+	if (!(proj->paths=(cJSON_Path**)h.malloc_fn((count?count:1)*sizeof(cJSON_Path*)))) {h.free_fn(proj);return 0;}
+	for (;proj->count<count;proj->count++)
+	{
+		if (!(proj->paths[proj->count]=cJSON_CompilePath(pointers[proj->count],&h))) {cJSON_DeleteProjection(proj);return 0;}
+		size+=proj->paths[proj->count]->count;
+	}
+	if (!(proj->nodes=(projection_node*)h.malloc_fn(size*sizeof(projection_node)))) {cJSON_DeleteProjection(proj);return 0;}
+	memset(proj->nodes,0,size*sizeof(projection_node));
+	proj->used=1;
+	for (i=0;i<count;i++)
+	{
+		for (node=0,j=0,token=proj->paths[i]->tokens;j<proj->paths[i]->count;j++,token++,node=c)
+		{
+			for (c=proj->nodes[node].child;c;c=proj->nodes[c].next)
+				if (proj->nodes[c].token.length==token->length && !memcmp(proj->nodes[c].token.key,token->key,token->length*sizeof(PFCHAR))) break;
+			if (c) continue;
+			c=proj->used++;
+			proj->nodes[c].token=*token;
+			proj->nodes[c].next=proj->nodes[node].child;proj->nodes[node].child=c;
+		}
+		proj->nodes[node].whole=1;
+	}
+	return proj;
+}
+
+/* Checking without building: each of these reads exactly what its parse_ counterpart accepts, allocating nothing, and
+returns one past it, or 0 with ps->ep set. */
+static const PFCHAR *scan_string(const PFCHAR *str,parse_state *ps)
+{
+	if (str>=ps->end || *str!=_T('\"')) {ps->ep=str;return 0;}
+	str=string_stop(str+1,ps->end);
+	return (str<ps->end && *str==_T('\"'))?str+1:str;
+}
+static const PFCHAR *scan_number(const PFCHAR *num,const PFCHAR *end)
+{
+	if (num<end && *num==_T('-')) num++;
+	if (num<end && *num==_T('0')) num++;
+	if (num<end && *num>=_T('1') && *num<=_T('9')) do num++; while (num<end && *num>=_T('0') && *num<=_T('9'));
+	if (end-num>1 && *num==_T('.') && num[1]>=_T('0') && num[1]<=_T('9')) do num++; while (num<end && *num>=_T('0') && *num<=_T('9'));
+	if (num<end && (*num==_T('e') || *num==_T('E')))
+	{
+		num++;
+		if (num<end && (*num==_T('+') || *num==_T('-'))) num++;
+		while (num<end && *num>=_T('0') && *num<=_T('9')) num++;
+	}
+	return num;
+}
+static const PFCHAR *scan_name(const PFCHAR *value,parse_state *ps)
+{
+	value=skip(scan_string(skip(value,ps),ps),ps);
+	if (!value) return 0;
+	if (value>=ps->end || *value!=_T(':')) {ps->ep=value;return 0;}
+	return skip(value+1,ps);
+}
+/* The value at value, inside depth open containers. The open ones are a bit each, set for objects. */
+static const PFCHAR *scan_value(const PFCHAR *value,parse_state *ps,int depth)
+{
+	unsigned char objects[(CJSON_NESTING_LIMIT+7)/8];int top=0,object;const PFCHAR *end=ps->end;
+	while (value)
+	{
+		if (value>=end)					{ps->ep=value;return 0;}
+		else if (end-value>=4 && !strncmp(value,_T("null"),4))	value+=4;
+		else if (end-value>=5 && !strncmp(value,_T("false"),5))	value+=5;
+		else if (end-value>=4 && !strncmp(value,_T("true"),4))	value+=4;
+		else if (*value==_T('\"'))		value=scan_string(value,ps);
+		else if (*value==_T('-') || (*value>=_T('0') && *value<=_T('9')))	value=scan_number(value,end);
+		else if (*value==_T('[') || *value==_T('{'))
+		{
+			object=(*value==_T('{'));
+			if (depth+top>=ps->max_depth || top>=CJSON_NESTING_LIMIT) {ps->ep=value;return 0;}	/* nested too deep. */
+			value=skip(value+1,ps);
+			if (value<end && *value==(object?_T('}'):_T(']'))) value++;	/* empty. */
+			else
+			{
+				if (object) objects[top/8]|=(unsigned char)(1<<(top%8)); else objects[top/8]&=(unsigned char)~(1<<(top%8));
+				top++;
+				if (object) value=scan_name(value,ps);
+				continue;
+			}
+		}
+		else {ps->ep=value;return 0;}
+
+		while (value && top)
+		{
+			object=(objects[(top-1)/8]>>((top-1)%8))&1;
+			value=skip(value,ps);
+			if (value<end && *value==_T(',')) {value=skip(value+1,ps);if (object) value=scan_name(value,ps);break;}
+			if (value<end && *value==(object?_T('}'):_T(']'))) {top--;value++;}
+			else {ps->ep=value;return 0;}
+		}
+		if (!top) break;
+	}
+	return value;
+}
+
+/* The child of node named by the member name at str: 0 if there is none, -1 if the name can't be read. */
+static int projection_child(const cJSON_Projection *proj,int node,const PFCHAR *str,parse_state *ps)
+{
+	const PFCHAR *key=str+1;size_t run;cJSON item;int c;
+	if (str>=ps->end || *str!=_T('\"')) {ps->ep=str;return -1;}
+	memset(&item,0,sizeof(cJSON));
+	run=clean_run(key,ps->end,key);
+	if (key+run>=ps->end || key[run]!=_T('\"'))	/* it has escapes: decode it. */
+	{
+		if (!parse_string(&item,str,ps)) return -1;
+		key=item.valuestring;run=strlen(key);
+	}
+	for (c=proj->nodes[node].child;c;c=proj->nodes[c].next)
+		if (proj->nodes[c].token.length==run && !memcmp(proj->nodes[c].token.key,key,run*sizeof(PFCHAR))) break;
+	if (item.valuestring) ps->hooks.free_fn(item.valuestring);
+	return c;
+}
+
+/* Parse the value at value through projection node: a whole node, or a scalar, is parsed as usual. Below the other
+nodes an object keeps the members the node names and an array keeps every element, each projected through the node
+again; scalars there are dropped, and everything dropped is checked by scan_value without being built. */
+static const PFCHAR *project_value(cJSON *item,const PFCHAR *value,int node,parse_state *ps)
+{
+	const cJSON_Projection *proj=ps->projection;const PFCHAR *name;cJSON *child,*tail=0;int object,next,max_depth;PFCHAR close;
+	if (proj->nodes[node].whole || value>=ps->end || (*value!=_T('[') && *value!=_T('{')))
+	{
+		max_depth=ps->max_depth;ps->max_depth-=ps->depth;
+		value=parse_tree(item,value,ps,0);
+		ps->max_depth=max_depth;
+		return value;
+	}
+	if (ps->depth>=ps->max_depth) {ps->ep=value;return 0;}	/* nested too deep. */
+	object=(*value==_T('{'));close=object?_T('}'):_T(']');
+	item->type=object?cJSON_Object:cJSON_Array;
+	stats_depth(ps->stats,++ps->depth);
+	value=skip(value+1,ps);
+	if (value<ps->end && *value==close) value++;	/* empty. */
+	else for (;;)
+	{
+		name=value;next=node;
+		if (object && ((next=projection_child(proj,node,value,ps))<0 || !(value=scan_name(value,ps)))) {value=0;break;}
+		if ((next || !object) && (proj->nodes[next].whole || (value<ps->end && (*value==_T('[') || *value==_T('{')))))
+		{
+			if (!(child=parse_new_item(ps))) {value=0;break;}	/* memory fail */
+			if (tail) {tail->next=child;child->prev=tail;} else item->child=child;
+			tail=child;
+			if (object && !parse_name(child,name,ps)) {value=0;break;}
+			value=project_value(child,value,next,ps);
+		}
+		else value=scan_value(value,ps,ps->depth);
+		if (!(value=skip(value,ps))) break;
+		if (value<ps->end && *value==_T(',')) {value=skip(value+1,ps);continue;}
+		if (value<ps->end && *value==close) value++;
+		else {ps->ep=value;value=0;}	/* malformed. */
+		break;
+	}
+	if (item->child) item->child->prev=tail;	/* the head points at the tail. */
+	ps->depth--;
+	return value;
+}
+
+cJSON *cJSON_ParseProjectedWithLength(cJSON_Projection *projection,const PFCHAR *value,size_t length)
+{
+	parse_state ps;cJSON *c;
+	if (!projection) return 0;
+	parse_init(&ps,0);ps.projection=projection;
+	c=parse_root(value,length,0,0,&ps);
+	ep=ps.ep;
+	return c;
+}
+cJSON *cJSON_ParseProjected(cJSON_Projection *projection,const PFCHAR *value) {return cJSON_ParseProjectedWithLength(projection,value,value?strlen(value):0);}
+
+/* Building and pruning a context's tree: no context means the global hooks, and an arena context's items go with its arena. */
+static void *context_alloc(cJSON_Context *ctx,size_t size)
+{
+	if (!ctx) return cJSON_malloc(size);
+	if (ctx->arena) return arena_alloc(ctx->arena,size);
+	return (ctx->hooks.malloc_fn?ctx->hooks.malloc_fn:malloc)(size);
+}
+static void context_free(cJSON_Context *ctx,void *ptr)	{if (!ctx) cJSON_free(ptr); else if (!ctx->arena) (ctx->hooks.free_fn?ctx->hooks.free_fn:free)(ptr);}
+static void context_delete(cJSON_Context *ctx,cJSON *c)	{if (!ctx) cJSON_Delete(c); else cJSON_DeleteWithContext(ctx,c);}
+static PFCHAR *context_strdup(cJSON_Context *ctx,const PFCHAR *str)
+{
+	size_t size=(strlen(str)+1)*sizeof(PFCHAR);PFCHAR *copy=(PFCHAR*)context_alloc(ctx,size);
+	if (copy) memcpy(copy,str,size);
+	return copy;
+}
+static cJSON *context_item(cJSON_Context *ctx,int type)
+{
+	cJSON *item=(cJSON*)context_alloc(ctx,sizeof(cJSON));
+	if (item) {memset(item,0,sizeof(cJSON));item->type=type;}
+	return item;
+}
 
 /* Utility for array list handling. */
 static void suffix_object(cJSON *prev,cJSON *item) {prev->next=item;item->prev=prev;}
 /* Utility for handling references. */
-static cJSON *create_reference(cJSON *item) {cJSON *ref=cJSON_New_Item();if (!ref) return 0;memcpy(ref,item,sizeof(cJSON));ref->string=0;ref->type|=cJSON_IsReference;ref->next=ref->prev=0;return ref;}
+static cJSON *create_reference(cJSON *item) {cJSON *ref;if (!expand(item) || !(ref=cJSON_New_Item())) return 0;memcpy(ref,item,sizeof(cJSON));ref->string=0;ref->index=0;ref->type|=cJSON_IsReference;ref->next=ref->prev=0;return ref;}
 
-/* Add item to array/object. */
-void   cJSON_AddItemToArray(cJSON *array, cJSON *item)						{cJSON *c=array->child;if (!item) return; if (!c) {array->child=item;} else {while (c && c->next) c=c->next; suffix_object(c,item);}}
-void   cJSON_AddItemToObject(cJSON *object,const PFCHAR *string,cJSON *item)	{if (!item) return; if (item->string) cJSON_free(item->string);item->string=cJSON_strdup(string);cJSON_AddItemToArray(object,item);}
+/* Add item to array/object. The head's prev points at the tail, so this is O(1); a list linked up
+by hand without that hint is walked from wherever the hint leaves off. */
+void   cJSON_AddItemToArray(cJSON *array, cJSON *item)
+{
+	cJSON *c;if (!item || !expand(array)) return;
+	c=array->child;
+	if (!c) {array->child=item;item->prev=item;item->next=0;}
+	else
+	{
+		if (c->prev) c=c->prev;
+		while (c->next) c=c->next;
+		suffix_object(c,item);item->next=0;array->child->prev=item;
+	}
+	if (array->index) index_append(array,item);
+}
+void   cJSON_AddItemToObjectWithContext(cJSON_Context *ctx,cJSON *object,const PFCHAR *string,cJSON *item)
+{
+	if (!item) return;
+	if (item->string && !(item->type&cJSON_StringIsConst)) context_free(ctx,item->string);
+	item->type&=~cJSON_StringIsConst;item->string=context_strdup(ctx,string);cJSON_AddItemToArray(object,item);
+}
+void   cJSON_AddItemToObject(cJSON *object,const PFCHAR *string,cJSON *item)	{cJSON_AddItemToObjectWithContext(0,object,string,item);}
+void   cJSON_AddItemToObjectCS(cJSON *object,const PFCHAR *string,cJSON *item)	{if (!item) return; if (item->string && !(item->type&cJSON_StringIsConst)) cJSON_free(item->string);item->type|=cJSON_StringIsConst;item->string=(PFCHAR*)string;cJSON_AddItemToArray(object,item);}
 void	cJSON_AddItemReferenceToArray(cJSON *array, cJSON *item)						{cJSON_AddItemToArray(array,create_reference(item));}
 void	cJSON_AddItemReferenceToObject(cJSON *object,const PFCHAR *string,cJSON *item)	{cJSON_AddItemToObject(object,string,create_reference(item));}
 
-cJSON *cJSON_DetachItemFromArray(cJSON *array,int which)			{cJSON *c=array->child;while (c && which>0) c=c->next,which--;if (!c) return 0;
-	if (c->prev) c->prev->next=c->next;if (c->next) c->next->prev=c->prev;if (c==array->child) array->child=c->next;c->prev=c->next=0;return c;}
+/* Unlink a known child (at position which, or -1 if unknown) from its parent. */
+static cJSON *detach_item(cJSON *parent,cJSON *c,int which)
+{
+	if (!c) return 0;
+	if (parent->index) index_remove(parent,c,which);
+	if (c==parent->child) {parent->child=c->next;if (c->next) c->next->prev=c->prev;}	/* the new head inherits the tail pointer. */
+	else
+	{
+		c->prev->next=c->next;
+		if (c->next) c->next->prev=c->prev; else parent->child->prev=c->prev;	/* detaching the tail. */
+	}
+	c->prev=c->next=0;return c;
+}
+cJSON *cJSON_DetachItemFromArray(cJSON *array,int which)			{if (which<0) which=0;return detach_item(array,cJSON_GetArrayItem(array,which),which);}
 void   cJSON_DeleteItemFromArray(cJSON *array,int which)			{cJSON_Delete(cJSON_DetachItemFromArray(array,which));}
-cJSON *cJSON_DetachItemFromObject(cJSON *object,const PFCHAR *string) {int i=0;cJSON *c=object->child;while (c && cJSON_strcasecmp(c->string,string)) i++,c=c->next;if (c) return cJSON_DetachItemFromArray(object,i);return 0;}
+cJSON *cJSON_DetachItemFromObject(cJSON *object,const PFCHAR *string) {return detach_item(object,cJSON_GetObjectItem(object,string),-1);}
 void   cJSON_DeleteItemFromObject(cJSON *object,const PFCHAR *string) {cJSON_Delete(cJSON_DetachItemFromObject(object,string));}
+void   cJSON_DeleteItemFromArrayWithContext(cJSON_Context *ctx,cJSON *array,int which)			{context_delete(ctx,cJSON_DetachItemFromArray(array,which));}
+void   cJSON_DeleteItemFromObjectWithContext(cJSON_Context *ctx,cJSON *object,const PFCHAR *string)	{context_delete(ctx,cJSON_DetachItemFromObject(object,string));}
+
+/* Swap a known child for newitem, and delete it. */
+static void replace_item(cJSON *parent,cJSON *c,cJSON *newitem,cJSON_Context *ctx)
+{
+	newitem->next=c->next;newitem->prev=c->prev;
+	if (c==parent->child) {parent->child=newitem;if (newitem->prev==c) newitem->prev=newitem;}	/* a lone child is its own tail. */
+	else newitem->prev->next=newitem;
+	if (newitem->next) newitem->next->prev=newitem; else if (parent->child->prev==c) parent->child->prev=newitem;
+	c->next=c->prev=0;context_delete(ctx,c);
+}
 
 /* Replace array/object items with new ones. */
-void   cJSON_ReplaceItemInArray(cJSON *array,int which,cJSON *newitem)		{cJSON *c=array->child;while (c && which>0) c=c->next,which--;if (!c) return;
-	newitem->next=c->next;newitem->prev=c->prev;if (newitem->next) newitem->next->prev=newitem;
-	if (c==array->child) array->child=newitem; else newitem->prev->next=newitem;c->next=c->prev=0;cJSON_Delete(c);}
-void   cJSON_ReplaceItemInObject(cJSON *object,const PFCHAR *string,cJSON *newitem){int i=0;cJSON *c=object->child;while(c && cJSON_strcasecmp(c->string,string))i++,c=c->next;if(c){newitem->string=cJSON_strdup(string);cJSON_ReplaceItemInArray(object,i,newitem);}}
+void   cJSON_ReplaceItemInArrayWithContext(cJSON_Context *ctx,cJSON *array,int which,cJSON *newitem)
+{
+	cJSON *c;struct cJSON_Index *ix=array->index;
+	if (which<0) which=0;
+	if (!(c=cJSON_GetArrayItem(array,which))) return;
+	if (ix) {index_stale_keys(ix);if (ix->items) ix->items[which]=newitem;}	/* the key may change: rebuild the table lazily. */
+	replace_item(array,c,newitem,ctx);
+}
+void   cJSON_ReplaceItemInObjectWithContext(cJSON_Context *ctx,cJSON *object,const PFCHAR *string,cJSON *newitem)
+{
+	cJSON *c=cJSON_GetObjectItem(object,string),**slot;
+	if (!c) return;
+	if (newitem->string && !(newitem->type&cJSON_StringIsConst)) context_free(ctx,newitem->string);
+	newitem->type&=~cJSON_StringIsConst;
+	newitem->string=context_strdup(ctx,string);
+	/* The new key folds to the same hash, so it can take over the old slot. */
+	if ((slot=index_slot_of(object->index,c))) *slot=newitem->string?newitem:&index_tombstone;
+	index_stale_items(object->index);
+	replace_item(object,c,newitem,ctx);
+}
+void   cJSON_ReplaceItemInArray(cJSON *array,int which,cJSON *newitem)				{cJSON_ReplaceItemInArrayWithContext(0,array,which,newitem);}
+void   cJSON_ReplaceItemInObject(cJSON *object,const PFCHAR *string,cJSON *newitem)	{cJSON_ReplaceItemInObjectWithContext(0,object,string,newitem);}
 
 /* Create basic types: */
-cJSON *cJSON_CreateNull(void)					{cJSON *item=cJSON_New_Item();if(item)item->type=cJSON_NULL;return item;}
-cJSON *cJSON_CreateTrue(void)					{cJSON *item=cJSON_New_Item();if(item)item->type=cJSON_True;return item;}
-cJSON *cJSON_CreateFalse(void)					{cJSON *item=cJSON_New_Item();if(item)item->type=cJSON_False;return item;}
-cJSON *cJSON_CreateBool(int b)					{cJSON *item=cJSON_New_Item();if(item)item->type=b?cJSON_True:cJSON_False;return item;}
-cJSON *cJSON_CreateNumber(double num)			{cJSON *item=cJSON_New_Item();if(item){item->type=cJSON_Number;item->valuedouble=num;item->valueint=(int)num;}return item;}
-cJSON *cJSON_CreateString(const PFCHAR *string)	{cJSON *item=cJSON_New_Item();if(item){item->type=cJSON_String;item->valuestring=cJSON_strdup(string);}return item;}
-cJSON *cJSON_CreateArray(void)					{cJSON *item=cJSON_New_Item();if(item)item->type=cJSON_Array;return item;}
-cJSON *cJSON_CreateObject(void)					{cJSON *item=cJSON_New_Item();if(item)item->type=cJSON_Object;return item;}
+cJSON *cJSON_CreateNullWithContext(cJSON_Context *ctx)					{return context_item(ctx,cJSON_NULL);}
+cJSON *cJSON_CreateBoolWithContext(cJSON_Context *ctx,int b)			{return context_item(ctx,b?cJSON_True:cJSON_False);}
+cJSON *cJSON_CreateNumberWithContext(cJSON_Context *ctx,double num)	{cJSON *item=context_item(ctx,cJSON_Number);if(item){item->valuedouble=num;item->valueint=double_to_int(num);}return item;}
+cJSON *cJSON_CreateStringWithContext(cJSON_Context *ctx,const PFCHAR *string)
+{
+	cJSON *item=context_item(ctx,cJSON_String);
+	if (item && !(item->valuestring=context_strdup(ctx,string))) {context_delete(ctx,item);item=0;}
+	return item;
+}
+cJSON *cJSON_CreateArrayWithContext(cJSON_Context *ctx)				{return context_item(ctx,cJSON_Array);}
+cJSON *cJSON_CreateObjectWithContext(cJSON_Context *ctx)				{return context_item(ctx,cJSON_Object);}
+cJSON *cJSON_CreateNull(void)					{return context_item(0,cJSON_NULL);}
+cJSON *cJSON_CreateTrue(void)					{return context_item(0,cJSON_True);}
+cJSON *cJSON_CreateFalse(void)					{return context_item(0,cJSON_False);}
+cJSON *cJSON_CreateBool(int b)					{return context_item(0,b?cJSON_True:cJSON_False);}
+cJSON *cJSON_CreateNumber(double num)			{return cJSON_CreateNumberWithContext(0,num);}
+cJSON *cJSON_CreateString(const PFCHAR *string)	{return cJSON_CreateStringWithContext(0,string);}
+cJSON *cJSON_CreateArray(void)					{return context_item(0,cJSON_Array);}
+cJSON *cJSON_CreateObject(void)					{return context_item(0,cJSON_Object);}
 
 /* Create Arrays: */
-cJSON *cJSON_CreateIntArray(const int *numbers,int count)		{int i;cJSON *n=0,*p=0,*a=cJSON_CreateArray();for(i=0;a && i<count;i++){n=cJSON_CreateNumber(numbers[i]);if(!i)a->child=n;else suffix_object(p,n);p=n;}return a;}
-cJSON *cJSON_CreateFloatArray(const float *numbers,int count)	{int i;cJSON *n=0,*p=0,*a=cJSON_CreateArray();for(i=0;a && i<count;i++){n=cJSON_CreateNumber(numbers[i]);if(!i)a->child=n;else suffix_object(p,n);p=n;}return a;}
-cJSON *cJSON_CreateDoubleArray(const double *numbers,int count)	{int i;cJSON *n=0,*p=0,*a=cJSON_CreateArray();for(i=0;a && i<count;i++){n=cJSON_CreateNumber(numbers[i]);if(!i)a->child=n;else suffix_object(p,n);p=n;}return a;}
-cJSON *cJSON_CreateStringArray(const PFCHAR **strings,int count)	{int i;cJSON *n=0,*p=0,*a=cJSON_CreateArray();for(i=0;a && i<count;i++){n=cJSON_CreateString(strings[i]);if(!i)a->child=n;else suffix_object(p,n);p=n;}return a;}
+cJSON *cJSON_CreateIntArray(const int *numbers,int count)		{int i;cJSON *n=0,*p=0,*a=cJSON_CreateArray();for(i=0;a && i<count;i++){n=cJSON_CreateNumber(numbers[i]);if(!i)a->child=n;else suffix_object(p,n);p=n;}if(a && n)a->child->prev=n;return a;}
+cJSON *cJSON_CreateFloatArray(const float *numbers,int count)	{int i;cJSON *n=0,*p=0,*a=cJSON_CreateArray();for(i=0;a && i<count;i++){n=cJSON_CreateNumber(numbers[i]);if(!i)a->child=n;else suffix_object(p,n);p=n;}if(a && n)a->child->prev=n;return a;}
+cJSON *cJSON_CreateDoubleArray(const double *numbers,int count)	{int i;cJSON *n=0,*p=0,*a=cJSON_CreateArray();for(i=0;a && i<count;i++){n=cJSON_CreateNumber(numbers[i]);if(!i)a->child=n;else suffix_object(p,n);p=n;}if(a && n)a->child->prev=n;return a;}
+cJSON *cJSON_CreateStringArray(const PFCHAR **strings,int count)	{int i;cJSON *n=0,*p=0,*a=cJSON_CreateArray();for(i=0;a && i<count;i++){n=cJSON_CreateString(strings[i]);if(!i)a->child=n;else suffix_object(p,n);p=n;}if(a && n)a->child->prev=n;return a;}
 
 /* Duplication */
-cJSON *cJSON_Duplicate(cJSON *item,int recurse)
+static cJSON *duplicate_item(cJSON *item,int recurse,cJSON_Context *ctx)
 {
-	cJSON *newitem,*cptr,*nptr=0,*newchild;
-	/* Bail on bad ptr */
-	if (!item) return 0;
+	cJSON *newitem;
 	/* Create new item */
-	newitem=cJSON_New_Item();
+	newitem=context_item(ctx,0);
 	if (!newitem) return 0;
 	/* Copy over all vars */
-	newitem->type=item->type&(~cJSON_IsReference),newitem->valueint=item->valueint,newitem->valuedouble=item->valuedouble;
-	if (item->valuestring)	{newitem->valuestring=cJSON_strdup(item->valuestring);	if (!newitem->valuestring)	{cJSON_Delete(newitem);return 0;}}
-	if (item->string)		{newitem->string=cJSON_strdup(item->string);			if (!newitem->string)		{cJSON_Delete(newitem);return 0;}}
+	newitem->type=item->type&(~(cJSON_IsReference|cJSON_StringIsConst)),newitem->valueint=item->valueint,newitem->valuedouble=item->valuedouble;
+	if (item->type&cJSON_IsLazy)	/* an unexpanded copy shares the text; without children it is just empty. */
+	{
+		if (recurse) newitem->valuestring=item->valuestring;
+		else newitem->type&=~cJSON_IsLazy,newitem->valueint=0;
+	}
+	else if (item->valuestring)	{newitem->valuestring=context_strdup(ctx,item->valuestring);	if (!newitem->valuestring)	{context_delete(ctx,newitem);return 0;}}
+	if (item->string)		{newitem->string=context_strdup(ctx,item->string);			if (!newitem->string)		{context_delete(ctx,newitem);return 0;}}
+	return newitem;
+}
+/* The children are copied depth first without recursion: each level being copied keeps the source item whose
+children they are and the copy they go under. */
+#define DUPLICATE_STACK 32
+cJSON *cJSON_DuplicateWithContext(cJSON_Context *ctx,cJSON *item,int recurse)
+{
+	cJSON *local[2*DUPLICATE_STACK],**stack=local,**grown,*newitem,*parent,*copy,*tail;int top=0,size=DUPLICATE_STACK;cJSON_Hooks h;
+	/* Bail on bad ptr */
+	if (!item || !(newitem=duplicate_item(item,recurse,ctx))) return 0;
 	/* If non-recursive, then we're done! */
 	if (!recurse) return newitem;
-	/* Walk the ->next chain for the child. */
-	cptr=item->child;
-	while (cptr)
+	parent=newitem;item=item->child;
+	while (item)
 	{
-		newchild=cJSON_Duplicate(cptr,1);		/* Duplicate (with recurse) each item in the ->next chain */
-		if (!newchild) {cJSON_Delete(newitem);return 0;}
-		if (nptr)	{nptr->next=newchild,newchild->prev=nptr;nptr=newchild;}	/* If newitem->child already set, then crosswire ->prev and ->next and move on */
-		else		{newitem->child=newchild;nptr=newchild;}					/* Set newitem->child and move to it */
-		cptr=cptr->next;
+		if (!(copy=duplicate_item(item,1,ctx))) {context_delete(ctx,newitem);newitem=0;break;}
+		if ((tail=parent->child)) {tail=tail->prev;tail->next=copy;copy->prev=tail;} else parent->child=copy;
+		parent->child->prev=copy;	/* the head points at the tail. */
+		if (item->child)	/* copy its children next, then carry on after it. */
+		{
+			if (top==size)
+			{
+				get_hooks(&h,ctx?&ctx->hooks:0);
+				if (!(grown=(cJSON**)h.malloc_fn(4*size*sizeof(cJSON*)))) {context_delete(ctx,newitem);newitem=0;break;}
+				memcpy(grown,stack,2*size*sizeof(cJSON*));
+				if (stack!=local) h.free_fn(stack);
+				stack=grown;size*=2;
+			}
+			stack[2*top]=item;stack[2*top+1]=parent;top++;
+			parent=copy;item=item->child;
+			continue;
+		}
+		while (!item->next && top) {top--;item=stack[2*top];parent=stack[2*top+1];}
+		item=item->next;
 	}
+	if (stack!=local) {get_hooks(&h,ctx?&ctx->hooks:0);h.free_fn(stack);}
 	return newitem;
 }
+cJSON *cJSON_Duplicate(cJSON *item,int recurse)	{return cJSON_DuplicateWithContext(0,item,recurse);}
+
+#ifdef CJSON_SSE2
+/* Minify the 16 PFCHARs at *json in one go, unless one is a '\\' or a '/': those need the scalar loop. The quotes'
+prefix xor marks which lanes are inside a string, and the whitespace outside of them is dropped. */
+static int minify_block(PFCHAR **into,PFCHAR **json,int *quoted)
+{
+	__m128i v=_mm_loadu_si128((const __m128i*)*json);char lanes[16];unsigned in,drop,i;
+	if (_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v,_mm_set1_epi8('\\')),_mm_cmpeq_epi8(v,_mm_set1_epi8('/'))))) return 0;
+	in=_mm_movemask_epi8(_mm_cmpeq_epi8(v,_mm_set1_epi8('\"')));
+	in^=in<<1;in^=in<<2;in^=in<<4;in^=in<<8;	/* a lane is in a string after an odd number of quotes. */
+	if (*quoted) in=~in;
+	drop=_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v,_mm_set1_epi8(' ')),_mm_cmpeq_epi8(v,_mm_set1_epi8('\t'))),
+		_mm_or_si128(_mm_cmpeq_epi8(v,_mm_set1_epi8('\r')),_mm_cmpeq_epi8(v,_mm_set1_epi8('\n')))))&~in;
+	*quoted=(in>>15)&1;
+	if (!drop) _mm_storeu_si128((__m128i*)*into,v),*into+=16;
+	else {_mm_storeu_si128((__m128i*)lanes,v);for (i=0;i<16;i++) {**into=lanes[i];*into+=!((drop>>i)&1);}}
+	*json+=16;
+	return 1;
+}
+#endif
 
-void cJSON_Minify(PFCHAR *json)
+/* Minify a block at a time where that's possible; a block minify_block can't take is stepped through a PFCHAR, comment
+or escape at a time, and back to blocks once past it, even inside a string. */
+size_t cJSON_MinifyWithLength(PFCHAR *json,size_t length)
 {
-	PFCHAR *into=json;
-	while (*json)
+	PFCHAR *into=json,*end=json+length;int quoted=0;
+#ifdef CJSON_SSE2
+	PFCHAR *scalar=json;	/* where the block a minify_block couldn't take ends. */
+#endif
+	if (!json) return 0;
+	while (json<end)
 	{
-		if (*json==_T(' ')) json++;
-		else if (*json==_T('\t')) json++;	/* Whitespace characters. */
-		else if (*json==_T('\r')) json++;
-		else if (*json==_T('\n')) json++;
-		else if (*json==_T('/') && json[1]==_T('/'))  while (*json && *json!=_T('\n')) json++;	/* double-slash comments, to end of line. */
-		else if (*json==_T('/') && json[1]==_T('*')) {while (*json && !(*json==_T('*') && json[1]==_T('/'))) json++;json+=2;}	/* multiline comments. */
-		else if (*json==_T('\"')){*into++=*json++;while (*json && *json!=_T('\"')){if (*json==_T('\\')) *into++=*json++;*into++=*json++;}*into++=*json++;} /* string literals, which are \" sensitive. */
-		else *into++=*json++;			/* All other characters. */
+#ifdef CJSON_SSE2
+		if (json>=scalar && end-json>=16)
+		{
+			if (minify_block(&into,&json,&quoted)) continue;
+			scalar=json+16;	/* step through this block before trying the next. */
+		}
+#endif
+		if (quoted || *json==_T('\"'))	/* string literals, which are \" sensitive. */
+		{
+			if (!quoted) *into++=*json++,quoted=1;
+			while (json<end)
+			{
+				if (*json==_T('\"')) {*into++=*json++;quoted=0;break;}
+				if (*json==_T('\\') && end-json>1) *into++=*json++;
+				*into++=*json++;
+#ifdef CJSON_SSE2
+				if (json>=scalar) break;	/* back to blocks, still quoted. */
+#endif
+			}
+		}
+		else if (*json==_T(' ') || *json==_T('\t') || *json==_T('\r') || *json==_T('\n')) json++;	/* Whitespace characters. */
+		else if (*json==_T('/') && end-json>1 && json[1]==_T('/')) {while (json<end && *json!=_T('\n')) json++;}	/* double-slash comments, to end of line. */
+		else if (*json==_T('/') && end-json>1 && json[1]==_T('*'))	/* multiline comments. */
+		{
+			for (json+=2;json<end && !(*json==_T('*') && end-json>1 && json[1]==_T('/'));json++);
+			json=(json<end)?json+2:end;
+		}
+		else *into++=*json++;	/* All other characters. */
 	}
-	*into=0;	/* and null-terminate. */
+	return into-(end-length);
 }
+void cJSON_Minify(PFCHAR *json)	{if (json) json[cJSON_MinifyWithLength(json,strlen(json))]=0;}
@@ -23,6 +23,9 @@
 #ifndef cJSON__h
 #define cJSON__h
 
+#include <stddef.h>	/* size_t */
+#include <stdio.h>	/* FILE, for record readers */
+
 /*#define USE_UNICODE*/
 
 #ifdef __cplusplus
@@ -40,6 +43,16 @@ extern "C"
 #define cJSON_Object 6
 	
 #define cJSON_IsReference 256
+#define cJSON_StringIsConst 512	/* The item's name string is not its own, so it is not freed with the item. */
+#define cJSON_IsLazy 1024		/* An array or object whose children are still unparsed text, see cJSON_ParseLazy. */
+
+/* The deepest nesting of arrays and objects a parse accepts, so hostile input can't make it build an absurdly deep
+tree. Parsing, printing, duplicating and deleting cJSON trees don't recurse, so any depth is safe for the C stack. The
+compact and tape parsers and cJSON_ExpandCompact and cJSON_ExpandTape do, a frame per level up to this limit. A context
+can set its own limit. */
+#ifndef CJSON_NESTING_LIMIT
+#define CJSON_NESTING_LIMIT 1000
+#endif
 
 #ifdef USE_UNICODE
 	#define PFCHAR wchar_t
@@ -53,7 +66,7 @@ extern "C"
 
 /* The cJSON structure: */
 typedef struct cJSON {
-	struct cJSON *next,*prev;	/* next/prev allow you to walk array/object chains. Alternatively, use GetArraySize/GetArrayItem/GetObjectItem */
+	struct cJSON *next,*prev;	/* next/prev allow you to walk array/object chains. Alternatively, use GetArraySize/GetArrayItem/GetObjectItem. The first child's prev points at the last child. */
 	struct cJSON *child;		/* An array or object item will have a child pointer pointing to a chain of the items in the array/object. */
 
 	int type;					/* The type of the item, as above. */
@@ -63,8 +76,12 @@ typedef struct cJSON {
 	double valuedouble;			/* The item's number, if type==cJSON_Number */
 
 	PFCHAR *string;				/* The item's name string, if this item is the child of, or is in the list of subitems of an object. */
+
+	struct cJSON_Index *index;	/* Optional lookup index over the children, see cJSON_BuildIndex. */
 } cJSON;
 
+/* Allocators. A function below that takes a cJSON_Hooks *hooks allocates through it, and a NULL hooks means the global
+ones set with cJSON_InitHooks; a NULL member means malloc or free. Arenas and contexts differ: NULL there means malloc/free. */
 typedef struct cJSON_Hooks {
       void *(*malloc_fn)(size_t sz);
       void (*free_fn)(void *ptr);
@@ -73,6 +90,61 @@ typedef struct cJSON_Hooks {
 /* Supply malloc, realloc and free functions to cJSON */
 extern void cJSON_InitHooks(cJSON_Hooks* hooks);
 
+/* An arena hands out nodes and strings from large chunks, so a whole parsed document is released in one go. */
+typedef struct cJSON_Arena cJSON_Arena;
+/* Create an arena that grows in chunk_size byte steps (0 picks a default). hooks supplies the chunk allocator; NULL means malloc/free. */
+extern cJSON_Arena *cJSON_CreateArena(size_t chunk_size,cJSON_Hooks *hooks);
+/* Release every document parsed into the arena at once, keeping its chunks for reuse. */
+extern void cJSON_ResetArena(cJSON_Arena *arena);
+/* Free the arena, its chunks and every document in it. */
+extern void cJSON_DeleteArena(cJSON_Arena *arena);
+
+/* A key table stores each distinct object key once. Trees parsed with it (through a context) or built with
+cJSON_AddItemToObjectCS and cJSON_InternKey point at its copies instead of owning their own, so key memory grows with
+the number of distinct keys rather than the number of members. Delete every such tree before the table. A table is
+not safe to share between threads that parse at the same time. */
+typedef struct cJSON_KeyTable cJSON_KeyTable;
+extern cJSON_KeyTable *cJSON_CreateKeyTable(cJSON_Hooks *hooks);
+/* The table's copy of key, added if it is new; 0 if out of memory. It lives as long as the table. */
+extern const PFCHAR *cJSON_InternKey(cJSON_KeyTable *table,const PFCHAR *key);
+/* How many distinct keys the table holds. */
+extern size_t cJSON_GetKeyTableSize(cJSON_KeyTable *table);
+extern void cJSON_DeleteKeyTable(cJSON_KeyTable *table);
+
+/* What one parse or print cost, filled in afresh by each call made through a context whose stats member points here.
+Allocations are those the call asked for: from the hooks, or from the arena for an arena parse. Times are wall clock. */
+typedef struct cJSON_Stats {
+	size_t nodes;				/* Items created (parse) or written (print). */
+	size_t string_bytes;		/* PFCHARs of strings and names after unescaping; parse only. */
+	int max_depth;				/* Deepest nesting of arrays and objects reached. */
+	size_t allocs,alloc_bytes;	/* Calls to malloc_fn (or the arena), and the bytes asked for, including realloc_fn. */
+	size_t reallocs;			/* Times the print buffer grew. */
+	size_t text_length;			/* PFCHARs of text parsed or printed. */
+	double total_us;			/* Microseconds the call took. */
+	double string_us,number_us;	/* Of which spent in strings and names, and in numbers, with cJSON_TimeStats; the rest is structure. */
+} cJSON_Stats;
+
+/* A context carries the allocator, options and error report for the calls made with it. Threads that each use
+their own context share no mutable state, so they can parse, print and delete concurrently. */
+typedef struct cJSON_Context {
+	cJSON_Hooks hooks;			/* Allocator for parsed trees and printed text. Zero members mean malloc/free. */
+	void *(*realloc_fn)(void *ptr,size_t sz);	/* If set, print buffers grow with this rather than malloc, copy and free. It must match hooks. */
+	cJSON_Arena *arena;			/* If set, parse into this arena instead. */
+	cJSON_KeyTable *keys;		/* If set, intern object keys in this table. */
+	cJSON_Stats *stats;			/* If set, parse and print report what they cost here. Unset, counting costs a test per node. */
+	int flags;					/* Parse options, as below. */
+	int max_depth;				/* Deepest nesting parse accepts; 0 means CJSON_NESTING_LIMIT. */
+	const PFCHAR *error_ptr;	/* Where the last parse failed, or 0 if it succeeded. */
+	int error_line,error_column;	/* 1-based line and column of error_ptr. */
+} cJSON_Context;
+
+/* Context flags: */
+#define cJSON_RequireNullTerminated 1	/* Fail on anything but whitespace after the value. */
+#define cJSON_TimeStats 2				/* Also time strings and numbers for stats: two clock reads per token. */
+
+/* Set up a context with the given allocator (NULL for malloc/free) and no options. */
+extern void cJSON_InitContext(cJSON_Context *ctx,cJSON_Hooks *hooks);
+
 
 /* Supply a block of JSON, and this returns a cJSON object you can interrogate. Call cJSON_Delete when finished. */
 extern cJSON *cJSON_Parse(const PFCHAR*value);
@@ -80,17 +152,88 @@ extern cJSON *cJSON_Parse(const PFCHAR*value);
 extern PFCHAR  *cJSON_Print(cJSON *item);
 /* Render a cJSON entity to text for transfer/storage without any formatting. Free the char* when finished. */
 extern PFCHAR  *cJSON_PrintUnformatted(cJSON *item);
+/* Render a cJSON entity to text using a buffered strategy. prebuffer is a guess at the final size. guessing well reduces reallocation. fmt=0 gives unformatted, =1 gives formatted. */
+extern PFCHAR  *cJSON_PrintBuffered(cJSON *item,int prebuffer,int fmt);
+/* Render a cJSON entity to text into a buffer you own, never allocating. Returns 1 on success and 0 if length (in PFCHARs, including the terminator) was too small. */
+extern int    cJSON_PrintPreallocated(cJSON *item,PFCHAR *buffer,int length,int fmt);
+/* Render a cJSON entity to a sink a piece at a time, so a large tree never needs its whole text in memory: the text
+goes out each time a buffer of buffer_size PFCHARs (0 for 64K) fills, and the buffer only grows for a single string
+longer than itself. The sink returns nonzero if it took all length PFCHARs. Returns 1 on success and 0 if the sink
+or an allocation failed, when part of the text may already have gone out. fmt as for cJSON_PrintBuffered. */
+typedef int (*cJSON_WriteCallback)(void *user,const PFCHAR *text,size_t length);
+extern int    cJSON_PrintToCallback(cJSON *item,int fmt,cJSON_WriteCallback sink,void *user,size_t buffer_size);
+/* The same, writing to an open file or file descriptor, which is left open (and a FILE* unflushed). */
+extern int    cJSON_PrintToFile(cJSON *item,int fmt,FILE *file);
+extern int    cJSON_PrintToFd(cJSON *item,int fmt,int fd);
 /* Delete a cJSON entity and all subentities. */
 extern void   cJSON_Delete(cJSON *c);
 
+/* The same, using the allocator and options of a context. Delete trees parsed with a context with the same context. */
+extern cJSON  *cJSON_ParseWithContext(cJSON_Context *ctx,const PFCHAR *value,const PFCHAR **return_parse_end);
+extern PFCHAR *cJSON_PrintWithContext(cJSON_Context *ctx,cJSON *item,int fmt);
+extern void    cJSON_DeleteWithContext(cJSON_Context *ctx,cJSON *c);
+/* The functions below that allocate or free (the creators, AddItemToObject, Duplicate, DeleteItemFrom and ReplaceItemIn)
+use the global hooks, so a tree parsed with a context must never be changed through them: use these counterparts with
+the tree's context. Detaching, cJSON_AddItemToArray and cJSON_AddItemToObjectCS allocate nothing and suit either;
+object indexes always come from the global hooks. With an arena context, what these make goes with the arena. */
+extern cJSON  *cJSON_CreateNullWithContext(cJSON_Context *ctx);
+extern cJSON  *cJSON_CreateBoolWithContext(cJSON_Context *ctx,int b);
+extern cJSON  *cJSON_CreateNumberWithContext(cJSON_Context *ctx,double num);
+extern cJSON  *cJSON_CreateStringWithContext(cJSON_Context *ctx,const PFCHAR *string);
+extern cJSON  *cJSON_CreateArrayWithContext(cJSON_Context *ctx);
+extern cJSON  *cJSON_CreateObjectWithContext(cJSON_Context *ctx);
+extern void    cJSON_AddItemToObjectWithContext(cJSON_Context *ctx,cJSON *object,const PFCHAR *string,cJSON *item);
+extern cJSON  *cJSON_DuplicateWithContext(cJSON_Context *ctx,cJSON *item,int recurse);
+extern void    cJSON_DeleteItemFromArrayWithContext(cJSON_Context *ctx,cJSON *array,int which);
+extern void    cJSON_DeleteItemFromObjectWithContext(cJSON_Context *ctx,cJSON *object,const PFCHAR *string);
+extern void    cJSON_ReplaceItemInArrayWithContext(cJSON_Context *ctx,cJSON *array,int which,cJSON *newitem);
+extern void    cJSON_ReplaceItemInObjectWithContext(cJSON_Context *ctx,cJSON *object,const PFCHAR *string,cJSON *newitem);
+
 /* Returns the number of items in an array (or object). */
 extern int	  cJSON_GetArraySize(cJSON *array);
 /* Retrieve item number "item" from array "array". Returns NULL if unsuccessful. */
 extern cJSON *cJSON_GetArrayItem(cJSON *array,int item);
 /* Get item "string" from object. Case insensitive. */
 extern cJSON *cJSON_GetObjectItem(cJSON *object,const PFCHAR *string);
+/* As GetObjectItem, but the key must match exactly. */
+extern cJSON *cJSON_GetObjectItemCaseSensitive(cJSON *object,const PFCHAR *string);
+
+/* Follow a JSON Pointer (RFC 6901) such as "/events/17/payload": each token names an object member, matched exactly,
+or an array index; ~1 and ~0 in a token stand for '/' and '~', and "" is root itself. NULL if anything is missing. */
+extern cJSON *cJSON_GetPointer(cJSON *root,const PFCHAR *pointer);
+/* A pointer compiled once, for looking up the same field in many documents without reading the pointer again.
+Returns NULL for a malformed pointer. */
+typedef struct cJSON_Path cJSON_Path;
+extern cJSON_Path *cJSON_CompilePath(const PFCHAR *pointer,cJSON_Hooks *hooks);
+extern void   cJSON_DeletePath(cJSON_Path *path);
+/* As cJSON_GetPointer. Members are found through an object's index, if it has one. */
+extern cJSON *cJSON_EvaluatePath(cJSON_Path *path,cJSON *root);
+/* Parse only the value the path names, straight from the text: everything before it is scanned past without building
+anything, and nothing after it is read. Returns the value as a tree of its own, or NULL if it isn't there. If the text
+is malformed on the way, cJSON_GetErrorPtr says where; what is scanned past is only checked for where it ends. */
+extern cJSON *cJSON_ParseAtPath(cJSON_Path *path,const PFCHAR *value);
+extern cJSON *cJSON_ParseAtPathWithLength(cJSON_Path *path,const PFCHAR *value,size_t length);
+
+/* Projections parse only the fields you ask for. Each pointer names a member to keep whole, along with the members on
+the way to it; arrays on the way keep every element, each projected the same way, and drop their scalars. Members named
+by no pointer are checked as cJSON_Parse would check them, but never built, so memory and time go with the fields kept.
+Array indexes in the pointers are read as member names. Returns NULL if a pointer is malformed. */
+typedef struct cJSON_Projection cJSON_Projection;
+extern cJSON_Projection *cJSON_CompileProjection(const PFCHAR **pointers,int count,cJSON_Hooks *hooks);
+extern void   cJSON_DeleteProjection(cJSON_Projection *projection);
+/* Parse a whole document through a projection. Call cJSON_Delete when finished. */
+extern cJSON *cJSON_ParseProjected(cJSON_Projection *projection,const PFCHAR *value);
+extern cJSON *cJSON_ParseProjectedWithLength(cJSON_Projection *projection,const PFCHAR *value,size_t length);
 
-/* For analysing failed parses. This returns a pointer to the parse error. You'll probably need to look a few chars back to make sense of it. Defined when cJSON_Parse() returns 0. 0 when cJSON_Parse() succeeds. */
+/* Index an array or object so GetArraySize/GetArrayItem take O(1), and for objects GetObjectItem, DetachItemFromObject and
+ReplaceItemInObject take O(1) on average. The index is kept up to date by the Add/Detach/Replace calls and freed with the item.
+If you relink ->child/->next yourself, call cJSON_BuildIndex again (or cJSON_DropIndex). Uses the global hooks, so don't index
+items inside an arena. Returns 0 on failure. */
+extern int  cJSON_BuildIndex(cJSON *item);
+extern void cJSON_DropIndex(cJSON *item);
+
+/* For analysing failed parses. This returns a pointer to the parse error. You'll probably need to look a few chars back to make sense of it. Defined when cJSON_Parse() returns 0. 0 when cJSON_Parse() succeeds.
+This is shared by every thread; use cJSON_ParseWithContext to parse from several threads at once. */
 extern const PFCHAR *cJSON_GetErrorPtr(void);
 	
 /* These calls create a cJSON item of the appropriate type. */
@@ -112,6 +255,9 @@ extern cJSON *cJSON_CreateStringArray(const PFCHAR **strings,int count);
 /* Append item to the specified array/object. */
 extern void cJSON_AddItemToArray(cJSON *array, cJSON *item);
 extern void	cJSON_AddItemToObject(cJSON *object,const PFCHAR *string,cJSON *item);
+/* Add an item to an object under a key that is used as it is, never copied or freed: a literal, an interned key, or
+anything else that outlives the object. */
+extern void	cJSON_AddItemToObjectCS(cJSON *object,const PFCHAR *string,cJSON *item);
 /* Append reference to item to the specified array/object. Use this when you want to add an existing cJSON to a new cJSON, but don't want to corrupt your existing cJSON. */
 extern void cJSON_AddItemReferenceToArray(cJSON *array, cJSON *item);
 extern void	cJSON_AddItemReferenceToObject(cJSON *object,const PFCHAR *string,cJSON *item);
@@ -134,8 +280,179 @@ The item->next and ->prev pointers are always zero on return from Duplicate. */
 
 /* ParseWithOpts allows you to require (and check) that the JSON is null terminated, and to retrieve the pointer to the final byte parsed. */
 extern cJSON *cJSON_ParseWithOpts(const PFCHAR *value,const PFCHAR **return_parse_end,int require_null_terminated);
+/* Parse exactly length PFCHARs, which need not be null terminated (a network frame, or a read-only memory mapped file).
+Nothing at or past value+length is read, so a mapping that ends right at length is safe; with require_null_terminated,
+only whitespace may follow the value. The other WithLength functions work the same way. */
+extern cJSON *cJSON_ParseWithLength(const PFCHAR *value,size_t length);
+extern cJSON *cJSON_ParseWithLengthOpts(const PFCHAR *value,size_t length,const PFCHAR **return_parse_end,int require_null_terminated);
+
+/* Parse in place: strings are unescaped within value and terminated over their closing quotes, so valuestring and string
+point into value and nothing but the nodes is allocated. value must outlive the tree, and is left garbled either way.
+Those items carry cJSON_IsReference (values) and cJSON_StringIsConst (names), so compare (type&255) with the type constants.
+cJSON_Delete the tree as usual; it leaves value alone. */
+extern cJSON *cJSON_ParseInSitu(PFCHAR *value);
+extern cJSON *cJSON_ParseInSituWithLength(PFCHAR *value,size_t length);
+
+/* Parse lazily: arrays and objects are only scanned for where they end, and their children are parsed the first time
+GetArraySize, GetArrayItem, GetObjectItem, cJSON_ArrayForEach or an Add/Detach/Replace call reaches them, one level at
+a time. Don't follow ->child of an item with cJSON_IsLazy set: go through those calls. value must outlive the tree.
+Errors inside a container only show when it is reached: the call then finds nothing and cJSON_GetErrorPtr says where.
+Printing a container that was never reached copies its text as it was. Reading the tree changes it, so guard one shared
+between threads with a lock. */
+extern cJSON *cJSON_ParseLazy(const PFCHAR *value);
+extern cJSON *cJSON_ParseLazyWithLength(const PFCHAR *value,size_t length);
+
+/* Parse a large top-level array on up to threads threads: a quick scan cuts it at top-level commas, each thread parses
+its share, and the pieces are joined into one array, the same as cJSON_ParseWithLength would build. Anything that isn't an
+array, or is too small to be worth splitting, is parsed on the calling thread. Uses the cJSON_InitHooks allocator from
+every thread, so it must be thread safe. Errors are reported through cJSON_GetErrorPtr. */
+extern cJSON *cJSON_ParseParallel(const PFCHAR *value,size_t length,int threads);
+/* Parse newline-delimited JSON (one value per line) on up to threads threads. Returns an array with one item per record,
+in order; blank lines are skipped. Fails as a whole if any record fails to parse. */
+extern cJSON *cJSON_ParseNDJSONParallel(const PFCHAR *value,size_t length,int threads);
+
+/* Parse into an arena. The tree lives until cJSON_ResetArena/cJSON_DeleteArena: never cJSON_Delete it or any item in it,
+and items you attach to it yourself are not released by the arena. */
+extern cJSON *cJSON_ParseInArena(cJSON_Arena *arena,const PFCHAR *value);
+extern cJSON *cJSON_ParseInArenaWithOpts(cJSON_Arena *arena,const PFCHAR *value,const PFCHAR **return_parse_end,int require_null_terminated);
+
+/* Streaming (SAX) parsing, for input too big to hold in memory. Feed the text in chunks of any size: the parser
+calls back for each event, and keeps only the nesting stack and the token in progress. Each callback returns nonzero
+to carry on, or 0 to stop parsing. key gets the unescaped name; value gets a scalar (string, number, true, false or
+null) that lives only until the callback returns. Any callback may be NULL. Several values one after another, such
+as line-delimited JSON, are reported in turn. */
+typedef struct cJSON_SAXCallbacks {
+	int (*start_object)(void *user);
+	int (*end_object)(void *user);
+	int (*start_array)(void *user);
+	int (*end_array)(void *user);
+	int (*key)(void *user,const PFCHAR *key);
+	int (*value)(void *user,cJSON *item);
+} cJSON_SAXCallbacks;
+typedef struct cJSON_SAXParser cJSON_SAXParser;
+/* Create a parser that passes user to callbacks. */
+extern cJSON_SAXParser *cJSON_CreateSAXParser(const cJSON_SAXCallbacks *callbacks,void *user,cJSON_Hooks *hooks);
+/* Parse the next length PFCHARs of the stream. Returns 0 on malformed input, memory failure or a stopping callback; the parser then refuses further input. */
+extern int    cJSON_FeedSAXParser(cJSON_SAXParser *sax,const PFCHAR *chunk,size_t length);
+/* Signal the end of the stream, reporting a trailing number. Returns 0 if the stream stopped inside a value. */
+extern int    cJSON_FinishSAXParser(cJSON_SAXParser *sax);
+/* PFCHARs consumed so far; after a failure, about where the stream went wrong. */
+extern size_t cJSON_GetSAXParserOffset(cJSON_SAXParser *sax);
+extern void   cJSON_DeleteSAXParser(cJSON_SAXParser *sax);
 
+/* Record streams: values one after another, usually one per line (NDJSON / JSON Lines). A reader hands back one record
+per call, parsed into storage it reuses: each record lives only until the next cJSON_ReadRecord or cJSON_DeleteRecordReader,
+so cJSON_Duplicate one to keep it, and never cJSON_Delete it. Streams are read in large blocks; a record longer than the
+buffer grows it. */
+typedef struct cJSON_RecordReader cJSON_RecordReader;
+/* Read records from length PFCHARs of text, which must outlive the reader. */
+extern cJSON_RecordReader *cJSON_CreateRecordReader(const PFCHAR *text,size_t length,cJSON_Hooks *hooks);
+/* Read records from an open file or file descriptor, which the reader doesn't close. */
+extern cJSON_RecordReader *cJSON_CreateRecordReaderFromFile(FILE *file,cJSON_Hooks *hooks);
+extern cJSON_RecordReader *cJSON_CreateRecordReaderFromFd(int fd,cJSON_Hooks *hooks);
+/* The next record, or 0 at the end of the input or on failure; cJSON_RecordReaderFailed tells which. */
+extern cJSON *cJSON_ReadRecord(cJSON_RecordReader *reader);
+extern int    cJSON_RecordReaderFailed(cJSON_RecordReader *reader);
+/* PFCHARs of input consumed so far; after a failure, where the bad record went wrong. */
+extern size_t cJSON_GetRecordReaderOffset(cJSON_RecordReader *reader);
+extern void   cJSON_DeleteRecordReader(cJSON_RecordReader *reader);
+
+/* A writer appends records to one growing buffer, each printed unformatted and followed by a newline. */
+typedef struct cJSON_RecordWriter cJSON_RecordWriter;
+extern cJSON_RecordWriter *cJSON_CreateRecordWriter(cJSON_Hooks *hooks);
+/* Append item as a record. Returns 0, leaving the text as it was, if it can't. */
+extern int    cJSON_WriteRecord(cJSON_RecordWriter *writer,cJSON *item);
+/* The records written since the last reset, NUL-terminated, with their length in PFCHARs if length isn't NULL.
+The text belongs to the writer and moves as it grows. */
+extern const PFCHAR *cJSON_GetRecordWriterText(cJSON_RecordWriter *writer,size_t *length);
+/* Empty the writer, keeping its buffer, e.g. once the text has been written out. */
+extern void   cJSON_ResetRecordWriter(cJSON_RecordWriter *writer);
+extern void   cJSON_DeleteRecordWriter(cJSON_RecordWriter *writer);
+
+/* Generators write JSON straight from calls, with no tree: begin an object, give each key and then its value, end it.
+The text comes out exactly as cJSON_Print (fmt=1) or cJSON_PrintUnformatted (fmt=0) would print the same tree. Calls
+are checked against the nesting (a key only directly inside an object, a value after each key, ends matching begins,
+one root value); the first one out of place, or that runs out of memory, fails the generator and every call after it
+returns 0. */
+typedef struct cJSON_Generator cJSON_Generator;
+/* Generate into a buffer that grows as needed. */
+extern cJSON_Generator *cJSON_CreateGenerator(int fmt,cJSON_Hooks *hooks);
+/* Generate to a sink through a buffer of buffer_size PFCHARs (0 for 64K), as cJSON_PrintToCallback. */
+extern cJSON_Generator *cJSON_CreateGeneratorToSink(int fmt,cJSON_WriteCallback sink,void *user,size_t buffer_size,cJSON_Hooks *hooks);
+extern int    cJSON_GenBeginObject(cJSON_Generator *gen);
+extern int    cJSON_GenEndObject(cJSON_Generator *gen);
+extern int    cJSON_GenBeginArray(cJSON_Generator *gen);
+extern int    cJSON_GenEndArray(cJSON_Generator *gen);
+extern int    cJSON_GenKey(cJSON_Generator *gen,const PFCHAR *key);
+extern int    cJSON_GenNumber(cJSON_Generator *gen,double number);
+extern int    cJSON_GenString(cJSON_Generator *gen,const PFCHAR *string);
+extern int    cJSON_GenBool(cJSON_Generator *gen,int b);
+extern int    cJSON_GenNull(cJSON_Generator *gen);
+/* Write an existing tree as the next value. */
+extern int    cJSON_GenItem(cJSON_Generator *gen,cJSON *item);
+/* Check the document is complete and, for a sink, send the rest of it. Returns 0 if anything went wrong. */
+extern int    cJSON_FinishGenerator(cJSON_Generator *gen);
+/* The text so far, NUL-terminated, with its length in PFCHARs if length isn't NULL; what hasn't gone to a sink yet. */
+extern const PFCHAR *cJSON_GetGeneratorText(cJSON_Generator *gen,size_t *length);
+/* Start a new document, keeping the buffer. */
+extern void   cJSON_ResetGenerator(cJSON_Generator *gen);
+extern void   cJSON_DeleteGenerator(cJSON_Generator *gen);
+
+/* Compact documents: a read-only parse that keeps each value in a 16-byte node (a tagged union linked by 32-bit
+indices, short strings stored inline) rather than a cJSON struct plus separate key and string blocks. Nodes are
+numbered, with 0 for none; every accessor accepts 0, so lookups can be chained. */
+typedef struct cJSON_Compact cJSON_Compact;
+typedef unsigned int cJSON_Node;
+extern cJSON_Compact *cJSON_ParseCompact(const PFCHAR *value);
+extern cJSON_Compact *cJSON_ParseCompactWithLength(const PFCHAR *value,size_t length);
+extern void   cJSON_DeleteCompact(cJSON_Compact *doc);
+/* Bytes held by the document. */
+extern size_t cJSON_GetCompactMemory(cJSON_Compact *doc);
+extern cJSON_Node cJSON_GetCompactRoot(cJSON_Compact *doc);
+/* The cJSON type of node, or -1 for none. */
+extern int    cJSON_GetCompactType(cJSON_Compact *doc,cJSON_Node node);
+extern double cJSON_GetCompactNumber(cJSON_Compact *doc,cJSON_Node node);
+extern const PFCHAR *cJSON_GetCompactString(cJSON_Compact *doc,cJSON_Node node);
+/* The name of an object member, or NULL. */
+extern const PFCHAR *cJSON_GetCompactName(cJSON_Compact *doc,cJSON_Node node);
+/* Walk and index arrays and objects, as GetArraySize/GetArrayItem/GetObjectItem (case insensitive). */
+extern int    cJSON_GetCompactSize(cJSON_Compact *doc,cJSON_Node node);
+extern cJSON_Node cJSON_GetCompactChild(cJSON_Compact *doc,cJSON_Node node);
+extern cJSON_Node cJSON_GetCompactNext(cJSON_Compact *doc,cJSON_Node node);
+extern cJSON_Node cJSON_GetCompactArrayItem(cJSON_Compact *doc,cJSON_Node node,int item);
+extern cJSON_Node cJSON_GetCompactObjectItem(cJSON_Compact *doc,cJSON_Node node,const PFCHAR *string);
+/* Copy node and everything under it into an ordinary tree, to modify or print. Call cJSON_Delete when finished. */
+extern cJSON *cJSON_ExpandCompact(cJSON_Compact *doc,cJSON_Node node);
+
+/* Tapes: a read-only parse flattened into one array of 8-byte entries in text order, with strings in a side buffer.
+Siblings sit next to each other and containers record where they end, so walking one never chases pointers.
+Positions on the tape are cJSON_Nodes, with 0 for none; every call accepts 0, so lookups can be chained. */
+typedef struct cJSON_Tape cJSON_Tape;
+extern cJSON_Tape *cJSON_ParseTape(const PFCHAR *value);
+extern cJSON_Tape *cJSON_ParseTapeWithLength(const PFCHAR *value,size_t length);
+extern void   cJSON_DeleteTape(cJSON_Tape *tape);
+/* Bytes held by the tape. */
+extern size_t cJSON_GetTapeMemory(cJSON_Tape *tape);
+extern cJSON_Node cJSON_GetTapeRoot(cJSON_Tape *tape);
+/* The cJSON type at node, or -1 for none. */
+extern int    cJSON_GetTapeType(cJSON_Tape *tape,cJSON_Node node);
+extern double cJSON_GetTapeNumber(cJSON_Tape *tape,cJSON_Node node);
+extern const PFCHAR *cJSON_GetTapeString(cJSON_Tape *tape,cJSON_Node node);
+/* The name of an object member, or NULL. */
+extern const PFCHAR *cJSON_GetTapeName(cJSON_Tape *tape,cJSON_Node node);
+/* Walk and index arrays and objects, as GetArraySize/GetArrayItem/GetObjectItem (case insensitive). */
+extern int    cJSON_GetTapeSize(cJSON_Tape *tape,cJSON_Node node);
+extern cJSON_Node cJSON_GetTapeChild(cJSON_Tape *tape,cJSON_Node node);
+extern cJSON_Node cJSON_GetTapeNext(cJSON_Tape *tape,cJSON_Node node);
+extern cJSON_Node cJSON_GetTapeArrayItem(cJSON_Tape *tape,cJSON_Node node,int item);
+extern cJSON_Node cJSON_GetTapeObjectItem(cJSON_Tape *tape,cJSON_Node node,const PFCHAR *string);
+/* Copy node and everything under it into an ordinary tree, to modify or print. Call cJSON_Delete when finished. */
+extern cJSON *cJSON_ExpandTape(cJSON_Tape *tape,cJSON_Node node);
+
+/* Strip whitespace and comments from JSON text in place, leaving string literals alone. */
 extern void cJSON_Minify(PFCHAR *json);
+/* The same for length PFCHARs that need not be NUL-terminated. Returns the new length; nothing is written past it. */
+extern size_t cJSON_MinifyWithLength(PFCHAR *json,size_t length);
 
 /* Macros for creating things quickly. */
 #define cJSON_AddNullToObject(object,name)		cJSON_AddItemToObject(object, name, cJSON_CreateNull())
@@ -145,6 +462,9 @@ extern void cJSON_Minify(PFCHAR *json);
 #define cJSON_AddNumberToObject(object,name,n)	cJSON_AddItemToObject(object, name, cJSON_CreateNumber(n))
 #define cJSON_AddStringToObject(object,name,s)	cJSON_AddItemToObject(object, name, cJSON_CreateString(s))
 
+/* Walk the items of an array or object. */
+#define cJSON_ArrayForEach(element,array)	for ((element)=(array)?cJSON_GetArrayItem(array,0):0;(element);(element)=(element)->next)
+
 /* When assigning an integer value, it needs to be propagated to valuedouble too. */
 #define cJSON_SetIntValue(object,val)			((object)?(object)->valueint=(object)->valuedouble=(val):(val))
 
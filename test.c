@@ -22,9 +22,18 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <math.h>
 #include "cJSON.h"
 #ifdef USE_UNICODE
 #include <tchar.h>
+#define strcmp _tcscmp
+#define strlen _tcslen
+#endif
+#if !defined(CJSON_NO_THREADS) && defined(_WIN32)
+#include <windows.h>
+#elif !defined(CJSON_NO_THREADS)
+#include <pthread.h>
 #endif
 
 /* Parse text to JSON, then render back to text, and print! */
@@ -145,7 +154,470 @@ void create_objects()
 
 }
 
+/* Nesting past CJSON_NESTING_LIMIT is refused by the parser, whole or cut into chunks for threads; trees built by hand
+can go far deeper, and still print, duplicate and delete, since none of those recurse. Returns how many failed. */
+#define PARALLEL_FILL 70000	/* "0," this many times gives cJSON_ParseParallel enough text to cut. */
+static PFCHAR *parallel_text(int depth)
+{
+	PFCHAR *text=(PFCHAR*)malloc((2*PARALLEL_FILL+2*depth+3)*sizeof(PFCHAR));int i,o=0;
+	text[o++]=_T('[');
+	for (i=0;i<PARALLEL_FILL;i++) text[o++]=_T('0'),text[o++]=_T(',');
+	for (i=0;i<depth;i++) text[o++]=_T('[');
+	for (i=0;i<depth;i++) text[o++]=_T(']');
+	text[o++]=_T(']');text[o]=0;
+	return text;
+}
+int deep_nesting()
+{
+	int i,depth=CJSON_NESTING_LIMIT+1,failures=0;PFCHAR *text=(PFCHAR*)malloc((2*depth+1)*sizeof(PFCHAR)),*out;cJSON *root,*item,*copy;
+
+	for (i=0;i<depth;i++) text[i]=_T('['),text[depth+i]=_T(']');
+	text[2*depth]=0;
+	root=cJSON_Parse(text+1);
+	wprintf(_T("%d deep: %s\n"),depth-1,root?_T("parsed"):_T("refused"));
+	failures+=!root;cJSON_Delete(root);
+	root=cJSON_Parse(text);
+	wprintf(_T("%d deep: %s\n"),depth,root?_T("parsed"):_T("refused"));
+	failures+=!!root;cJSON_Delete(root);
+	free(text);
+
+	/* The same, as the last element of an array long enough to be parsed in parallel: one level less inside it. */
+	for (i=depth-2;i<depth;i++)
+	{
+		text=parallel_text(i);root=cJSON_ParseParallel(text,strlen(text),4);
+		wprintf(_T("%d deep in parallel: %s\n"),i+1,root?_T("parsed"):_T("refused"));
+		failures+=(i<depth-1)?!root:!!root;
+		if (root && cJSON_GetErrorPtr()) failures++;	/* the refusal before it is no error of this parse. */
+		cJSON_Delete(root);free(text);
+	}
+
+	root=item=cJSON_CreateArray();
+	for (i=1;i<1000000;i++) {cJSON_AddItemToArray(item,cJSON_CreateArray());item=item->child;}
+	copy=cJSON_Duplicate(root,1);
+	out=cJSON_PrintUnformatted(copy);
+	wprintf(_T("1000000 deep: %s\n"),(copy && out)?_T("duplicated and printed"):_T("failed"));
+	failures+=!copy || !out;
+	free(out);
+	cJSON_Delete(copy);
+	cJSON_Delete(root);
+	return failures;
+}
+
+/* Numbers print in the fewest digits that read back as the same double: subnormals, the integers around 2^53, and values
+that take all 17 digits, then random doubles of every magnitude. Returns how many failed. */
+static const PFCHAR *number_texts[][2]={
+	{_T("5e-324"),_T("5e-324")},{_T("4.9406564584124654e-324"),_T("5e-324")},{_T("2.225073858507201e-308"),_T("2.225073858507201e-308")},
+	{_T("2.2250738585072014e-308"),_T("2.2250738585072014e-308")},{_T("1.7976931348623157e308"),_T("1.7976931348623157e+308")},
+	{_T("9007199254740991"),_T("9007199254740991")},{_T("9007199254740993"),_T("9007199254740992")},{_T("9007199254740995"),_T("9007199254740996")},
+	{_T("0.1"),_T("0.1")},{_T("0.30000000000000004"),_T("0.30000000000000004")},{_T("1.2345678901234567"),_T("1.2345678901234567")},
+	{_T("123456789012345678"),_T("1.2345678901234568e+17")},{_T("1e23"),_T("1e+23")},{_T("5.9604644775390625e-8"),_T("5.960464477539063e-08")},
+	{_T("-0.0001"),_T("-0.0001")},{_T("0.00001"),_T("1e-05")},{_T("-2.5e-7"),_T("-2.5e-07")}};
+int number_round_trip()
+{
+	int i,failures=0;unsigned long seed=1,hi,lo;double d;PFCHAR *out;cJSON *item,*back;
+
+	for (i=0;i<(int)(sizeof(number_texts)/sizeof(*number_texts));i++)
+	{
+		item=cJSON_Parse(number_texts[i][0]);out=item?cJSON_PrintUnformatted(item):0;
+		if (!out || strcmp(out,number_texts[i][1])) {failures++;wprintf(_T("%s printed as %s\n"),number_texts[i][0],out?out:_T("nothing"));}
+		free(out);cJSON_Delete(item);
+	}
+	for (i=0;i<200000;i++)
+	{
+		seed=seed*1103515245UL+12345UL;hi=(seed>>6)&0x3ffffff;
+		seed=seed*1103515245UL+12345UL;lo=(seed>>6)&0x3ffffff;
+		d=(hi*67108864.0+lo)/4503599627370496.0;		/* 52 random bits in [0,1) */
+		seed=seed*1103515245UL+12345UL;
+		d=(i&3)?ldexp(1+d,(int)((seed>>8)%2046)-1022):ldexp(d,-1022);	/* every fourth subnormal */
+		if (i&1) d=-d;
+		item=cJSON_CreateNumber(d);out=cJSON_PrintUnformatted(item);back=out?cJSON_Parse(out):0;
+		if (!back || back->valuedouble!=d) failures++;
+		cJSON_Delete(back);free(out);cJSON_Delete(item);
+	}
+	wprintf(_T("numbers: %d failures\n"),failures);
+	return failures;
+}
+
+/* SAX events rebuilt into a tree: root holds each top-level value in turn. With stop set, the callback that makes
+that many events returns 0. */
+typedef struct {cJSON *root,*stack[16],*key;int depth,events,stop;} sax_tree;
+static int sax_go(sax_tree *t)	{return !t->stop || ++t->events<t->stop;}
+static void sax_attach(sax_tree *t,cJSON *item)
+{
+	cJSON *parent=t->depth?t->stack[t->depth-1]:t->root;
+	if (t->key) {cJSON_AddItemToObject(parent,t->key->valuestring,item);cJSON_Delete(t->key);t->key=0;}
+	else cJSON_AddItemToArray(parent,item);
+}
+static int sax_open(sax_tree *t,cJSON *item)		{sax_attach(t,item);t->stack[t->depth++]=item;return sax_go(t);}
+static int sax_start_object(void *user)				{return sax_open((sax_tree*)user,cJSON_CreateObject());}
+static int sax_start_array(void *user)				{return sax_open((sax_tree*)user,cJSON_CreateArray());}
+static int sax_end(void *user)						{((sax_tree*)user)->depth--;return sax_go((sax_tree*)user);}
+static int sax_key(void *user,const PFCHAR *key)	{((sax_tree*)user)->key=cJSON_CreateString(key);return sax_go((sax_tree*)user);}
+static int sax_value(void *user,cJSON *item)		{sax_attach((sax_tree*)user,cJSON_Duplicate(item,0));return sax_go((sax_tree*)user);}
+static const cJSON_SAXCallbacks sax_callbacks={sax_start_object,sax_end,sax_start_array,sax_end,sax_key,sax_value};
+
+/* Feed text in two chunks split at split, or a PFCHAR at a time if split<0, then finish. Returns what the events built,
+printed, or 0 if the parser failed. */
+static PFCHAR *sax_run(const PFCHAR *text,int split,sax_tree *t)
+{
+	cJSON_SAXParser *sax=cJSON_CreateSAXParser(&sax_callbacks,t,0);int len=(int)strlen(text),i,ok=1;PFCHAR *out;
+	t->root=cJSON_CreateArray();t->depth=t->events=0;t->key=0;
+	if (split<0) for (i=0;i<len && ok;i++) ok=cJSON_FeedSAXParser(sax,text+i,1);
+	else ok=cJSON_FeedSAXParser(sax,text,split) && cJSON_FeedSAXParser(sax,text+split,len-split);
+	ok=ok && cJSON_FinishSAXParser(sax);
+	out=ok?cJSON_PrintUnformatted(t->root):0;
+	cJSON_DeleteSAXParser(sax);cJSON_Delete(t->root);cJSON_Delete(t->key);
+	return out;
+}
+
+/* The same values by cJSON_ParseWithOpts, one after another. */
+static PFCHAR *sax_expect(const PFCHAR *text)
+{
+	cJSON *root=cJSON_CreateArray(),*item;const PFCHAR *end=text;PFCHAR *out;
+	while ((item=cJSON_ParseWithOpts(end,&end,0))) cJSON_AddItemToArray(root,item);
+	out=cJSON_PrintUnformatted(root);cJSON_Delete(root);
+	return out;
+}
+
+/* Documents fed to the SAX parser at every split point and a PFCHAR at a time must give the events cJSON_ParseWithOpts
+builds: escapes and surrogate pairs, numbers cut anywhere, several values in a row, and a number only cJSON_FinishSAXParser
+can end. A callback returning 0 stops the stream for good. Returns how many failed. */
+static const PFCHAR *sax_texts[]={
+	_T("{\"a\\\"b\":\"x\\\\y\\n\\u00e9\\ud83d\\ude00 \\/\",\"list\":[1,-2.5e-3,true,false,null,{},[]],\"o\":{\"k\":\"v\"}}"),
+	_T("[12345.678e-9,-0.0,1e300,123456789012345678901,0,-7,2.5E+10]"),
+	_T(" {\"x\":1} [2]\n\"s\" true 42"),
+	_T("-31.25e+2")};
+int sax_chunks()
+{
+	int i,split,failures=0;PFCHAR *expect,*got;sax_tree t;cJSON_SAXParser *sax;
+
+	memset(&t,0,sizeof(t));
+	for (i=0;i<(int)(sizeof(sax_texts)/sizeof(*sax_texts));i++)
+	{
+		expect=sax_expect(sax_texts[i]);
+		for (split=-1;split<=(int)strlen(sax_texts[i]);split++)
+		{
+			got=sax_run(sax_texts[i],split,&t);
+			if (!got || strcmp(got,expect)) {failures++;wprintf(_T("SAX split at %d: %s\n"),split,got?got:_T("failed"));}
+			free(got);
+		}
+		free(expect);
+	}
+
+	/* Stopping at the third event, the first member's value, fails this chunk and any after it, with no more events. */
+	t.stop=3;
+	for (split=-1;split<=(int)strlen(sax_texts[0]);split++)
+		if (sax_run(sax_texts[0],split,&t) || t.events!=3) failures++;
+	t.stop=0;
+
+	/* A number at the end of the stream is only known to be whole at the finish. */
+	t.root=cJSON_CreateArray();t.depth=0;
+	sax=cJSON_CreateSAXParser(&sax_callbacks,&t,0);
+	if (!cJSON_FeedSAXParser(sax,sax_texts[3],strlen(sax_texts[3])) || cJSON_GetArraySize(t.root)!=0) failures++;
+	if (!cJSON_FinishSAXParser(sax) || cJSON_GetArraySize(t.root)!=1 || t.root->child->valuedouble!=-3125) failures++;
+	cJSON_DeleteSAXParser(sax);cJSON_Delete(t.root);
+
+	wprintf(_T("SAX: %d failures\n"),failures);
+	return failures;
+}
+
+/* Whether two lookups found the same thing: both nothing, or values that print alike. */
+static int same_value(cJSON *a,cJSON *b)
+{
+	PFCHAR *x,*y;int same;
+	if (!a || !b) return a==b;
+	x=cJSON_PrintUnformatted(a);y=cJSON_PrintUnformatted(b);
+	same=x && y && !strcmp(x,y);
+	free(x);free(y);
+	return same;
+}
+
+/* cJSON_ParseAtPath and projections must find what cJSON_GetPointer finds in the full parse: through arrays, ~0 and ~1
+escapes, and members that aren't there. Text that is malformed in a member they skip is read as documented: a path only
+checks where it ends, a projection checks it as cJSON_Parse does. Returns how many failed. */
+static const PFCHAR *paths_text=_T("{\"id\":7,\"skip\":{\"deep\":[1,{\"x\":\"y\"}],\"s\":\"\\\"}]\"},\"a/b\":{\"m~n\":[10,20,{\"k\":true}]},"
+	"\"list\":[{\"name\":\"n0\",\"v\":1},{\"name\":\"n1\",\"v\":2,\"extra\":[3]}],\"tail\":null}");
+static const PFCHAR *paths[]={_T(""),_T("/id"),_T("/a~1b"),_T("/a~1b/m~0n"),_T("/a~1b/m~0n/2/k"),_T("/list/1"),_T("/list/1/extra/0"),
+	_T("/skip/deep/1/x"),_T("/tail"),_T("/nope"),_T("/list/5"),_T("/id/x"),_T("/a~1b/m~0n/x"),_T("/a~0b"),_T("/list/01")};
+static const PFCHAR *projected[]={_T("/id"),_T("/a~1b/m~0n"),_T("/list/name"),_T("/nope")};
+static const PFCHAR *projected_check[][2]={{_T("/id"),_T("/id")},{_T("/a~1b/m~0n"),_T("/a~1b/m~0n")},{_T("/list/0/name"),_T("/list/0/name")},
+	{_T("/list/1/name"),_T("/list/1/name")},{_T("/nope"),_T("/nope")},{_T("/list/0/v"),0},{_T("/list/1/extra"),0},{_T("/skip"),0},{_T("/tail"),0}};
+int paths_and_projections()
+{
+	cJSON *full=cJSON_Parse(paths_text),*got,*proj_tree;cJSON_Path *path;cJSON_Projection *proj;int i,failures=0;
+
+	for (i=0;i<(int)(sizeof(paths)/sizeof(*paths));i++)
+	{
+		path=cJSON_CompilePath(paths[i],0);got=cJSON_ParseAtPath(path,paths_text);
+		if (!path || !same_value(got,cJSON_GetPointer(full,paths[i]))) {failures++;wprintf(_T("path %s differs\n"),paths[i]);}
+		cJSON_Delete(got);cJSON_DeletePath(path);
+	}
+	path=cJSON_CompilePath(_T("/id"),0);
+	if (!(got=cJSON_ParseAtPath(path,_T("{\"skip\":[1,,2],\"id\":7}"))) || got->valueint!=7) failures++;	/* only its end is found */
+	cJSON_Delete(got);
+	if ((got=cJSON_ParseAtPath(path,_T("{\"skip\":[1,2,\"id\":7}")))) failures++;	/* but it must end */
+	cJSON_Delete(got);
+	if ((got=cJSON_ParseAtPath(path,_T("{\"id\":[1,,2]}")))) failures++;	/* and what it returns is parsed in full */
+	cJSON_Delete(got);
+	cJSON_DeletePath(path);
+
+	proj=cJSON_CompileProjection(projected,(int)(sizeof(projected)/sizeof(*projected)),0);
+	proj_tree=cJSON_ParseProjected(proj,paths_text);
+	for (i=0;i<(int)(sizeof(projected_check)/sizeof(*projected_check));i++)
+		if (!proj_tree || !same_value(cJSON_GetPointer(proj_tree,projected_check[i][0]),projected_check[i][1]?cJSON_GetPointer(full,projected_check[i][1]):0))
+			{failures++;wprintf(_T("projection of %s differs\n"),projected_check[i][0]);}
+	cJSON_Delete(proj_tree);
+	if ((got=cJSON_ParseProjected(proj,_T("{\"skip\":[1,,2],\"id\":7}")))) failures++;	/* skipped, but still checked */
+	cJSON_Delete(got);
+	if (!(got=cJSON_ParseProjected(proj,_T("{\"list\":[{\"name\":1},5,{\"name\":2}]}"))) || cJSON_GetArraySize(cJSON_GetPointer(got,_T("/list")))!=2) failures++;	/* scalars go */
+	cJSON_Delete(got);
+	cJSON_DeleteProjection(proj);
+	cJSON_Delete(full);
+
+	wprintf(_T("paths and projections: %d failures\n"),failures);
+	return failures;
+}
+
+/* Every other way to parse must expand to the tree cJSON_Parse builds. Each reader gets the text and its length, and
+returns a cJSON tree to print and delete. */
+static cJSON *read_insitu(const PFCHAR *text,size_t length)
+{
+	PFCHAR *copy=(PFCHAR*)malloc((length+1)*sizeof(PFCHAR));cJSON *tree,*dup;
+	memcpy(copy,text,(length+1)*sizeof(PFCHAR));
+	tree=cJSON_ParseInSitu(copy);dup=cJSON_Duplicate(tree,1);	/* the copy won't outlive this call */
+	return cJSON_Delete(tree),free(copy),dup;
+}
+static cJSON *read_bounded(const PFCHAR *text,size_t length)
+{
+	PFCHAR *copy=(PFCHAR*)malloc((length?length:1)*sizeof(PFCHAR));cJSON *tree;	/* no terminator, and nothing past it to read */
+	memcpy(copy,text,length*sizeof(PFCHAR));
+	tree=cJSON_ParseWithLength(copy,length);
+	return free(copy),tree;
+}
+static cJSON *read_compact(const PFCHAR *text,size_t length)
+{
+	cJSON_Compact *doc=cJSON_ParseCompactWithLength(text,length);cJSON *tree=doc?cJSON_ExpandCompact(doc,cJSON_GetCompactRoot(doc)):0;
+	return cJSON_DeleteCompact(doc),tree;
+}
+static cJSON *read_tape(const PFCHAR *text,size_t length)
+{
+	cJSON_Tape *tape=cJSON_ParseTapeWithLength(text,length);cJSON *tree=tape?cJSON_ExpandTape(tape,cJSON_GetTapeRoot(tape)):0;
+	return cJSON_DeleteTape(tape),tree;
+}
+static void reach_all(cJSON *item)	{int i,n=cJSON_GetArraySize(item);for (i=0;i<n;i++) reach_all(cJSON_GetArrayItem(item,i));}
+static cJSON *read_lazy(const PFCHAR *text,size_t length)
+{
+	cJSON *tree=cJSON_ParseLazyWithLength(text,length),*copy;
+	reach_all(tree);copy=cJSON_Duplicate(tree,1);	/* the text won't outlive the caller's */
+	return cJSON_Delete(tree),copy;
+}
+static const struct {const PFCHAR *name;cJSON *(*read)(const PFCHAR*,size_t);} readers[]={
+	{_T("in-situ"),read_insitu},{_T("length-bounded"),read_bounded},{_T("compact"),read_compact},{_T("tape"),read_tape},{_T("lazy"),read_lazy}};
+static const PFCHAR *reader_texts[]={_T("0"),_T("\"\""),_T("null"),_T("[]"),_T("{}"),_T(" [ 1 , -2.5e-3 , true , false , null ] "),
+	_T("{\"a\":{\"b\":[[],{},[[1]]]},\"\":\"\",\"e\\u00e9\":\"tab\\t\\\"q\\\" \\ud83d\\ude00 \\/\"}"),
+	_T("[\"a,b\",{\"k\":\"}]\"},1e308,123456789012345678901234567890,[{\"x\":[{\"y\":[null]}]}]]")};
+int representations()
+{
+	int i,r,failures=0;cJSON *want,*got;PFCHAR *a,*b,bad[5];
+
+	for (i=0;i<(int)(sizeof(reader_texts)/sizeof(*reader_texts));i++)
+	{
+		want=cJSON_Parse(reader_texts[i]);a=cJSON_Print(want);
+		for (r=0;r<(int)(sizeof(readers)/sizeof(*readers));r++)
+		{
+			got=readers[r].read(reader_texts[i],strlen(reader_texts[i]));b=got?cJSON_Print(got):0;
+			if (!a || !b || strcmp(a,b)) {failures++;wprintf(_T("%s reading of text %d differs\n"),readers[r].name,i);}
+			free(b);cJSON_Delete(got);
+		}
+		free(a);cJSON_Delete(want);
+	}
+	/* cJSON_Parse lets a string run to the terminator; in place there is nowhere to put its own. */
+	memcpy(bad,_T("\"abc"),sizeof(bad));
+	if (!(want=cJSON_Parse(bad))) failures++;
+	cJSON_Delete(want);
+	if ((got=cJSON_ParseInSitu(bad))) failures++;
+	cJSON_Delete(got);
+
+	wprintf(_T("representations: %d failures\n"),failures);
+	return failures;
+}
+
+/* Compact documents and tapes must answer every accessor as the tree cJSON_Parse builds would: type, number, string,
+name and size at each value, and the same child by position and by name. The two APIs match name for name, so one
+comparison is written for both. Returns how many values differ. */
+static int same_string(const PFCHAR *a,const PFCHAR *b)	{return (!a || !b)?a==b:!strcmp(a,b);}
+#define READ_ONLY_DIFFERS(Kind) \
+static int Kind##_differs(cJSON *item,cJSON_##Kind *doc,cJSON_Node node) \
+{ \
+	cJSON *c;cJSON_Node child=cJSON_Get##Kind##Child(doc,node);int i,failures=0,type=item->type&255; \
+	if (cJSON_Get##Kind##Type(doc,node)!=type || cJSON_Get##Kind##Number(doc,node)!=((type==cJSON_Number)?item->valuedouble:0) \
+		|| !same_string(cJSON_Get##Kind##String(doc,node),(type==cJSON_String)?item->valuestring:0) \
+		|| !same_string(cJSON_Get##Kind##Name(doc,node),item->string) || cJSON_Get##Kind##Size(doc,node)!=cJSON_GetArraySize(item)) failures++; \
+	for (c=item->child,i=0;c;c=c->next,i++,child=cJSON_Get##Kind##Next(doc,child)) \
+	{ \
+		if (!child || cJSON_Get##Kind##ArrayItem(doc,node,i)!=child) failures++; \
+		if (c->string && cJSON_GetObjectItem(item,c->string)==c && cJSON_Get##Kind##ObjectItem(doc,node,c->string)!=child) failures++; \
+		failures+=Kind##_differs(c,doc,child); \
+	} \
+	return failures+(child!=0); \
+}
+READ_ONLY_DIFFERS(Compact)
+READ_ONLY_DIFFERS(Tape)
+int read_only_forms()
+{
+	int i,failures=0;cJSON *tree;cJSON_Compact *doc;cJSON_Tape *tape;
+	for (i=0;i<(int)(sizeof(reader_texts)/sizeof(*reader_texts));i++)
+	{
+		tree=cJSON_Parse(reader_texts[i]);doc=cJSON_ParseCompact(reader_texts[i]);tape=cJSON_ParseTape(reader_texts[i]);
+		if (!tree || !doc || !tape) failures++;
+		else failures+=Compact_differs(tree,doc,cJSON_GetCompactRoot(doc))+Tape_differs(tree,tape,cJSON_GetTapeRoot(tape));
+		if (!cJSON_GetCompactMemory(doc) || !cJSON_GetTapeMemory(tape)) failures++;
+		cJSON_Delete(tree);cJSON_DeleteCompact(doc);cJSON_DeleteTape(tape);
+	}
+	wprintf(_T("compact and tape: %d failures\n"),failures);
+	return failures;
+}
+
+/* The minifier cJSON had before it went a block at a time, verbatim, to check the current one against. */
+static void loop_minify(PFCHAR *json)
+{
+	PFCHAR *into=json;
+	while (*json)
+	{
+		if (*json==_T(' ')) json++;
+		else if (*json==_T('\t')) json++;	/* Whitespace characters. */
+		else if (*json==_T('\r')) json++;
+		else if (*json==_T('\n')) json++;
+		else if (*json==_T('/') && json[1]==_T('/'))  while (*json && *json!=_T('\n')) json++;	/* double-slash comments, to end of line. */
+		else if (*json==_T('/') && json[1]==_T('*')) {while (*json && !(*json==_T('*') && json[1]==_T('/'))) json++;json+=2;}	/* multiline comments. */
+		else if (*json==_T('\"')){*into++=*json++;while (*json && *json!=_T('\"')){if (*json==_T('\\')) *into++=*json++;*into++=*json++;}*into++=*json++;} /* string literals, which are \" sensitive. */
+		else *into++=*json++;			/* All other characters. */
+	}
+	*into=0;	/* and null-terminate. */
+}
+
+/* cJSON_Minify and cJSON_MinifyWithLength must leave what loop_minify leaves, over texts made of whitespace, comments
+and strings holding '/', '\\', quotes and comment openers, at every offset against the 16-PFCHAR blocks. The loop looks
+for the closing star and slash from the opening slash on, so it ends a block comment whose body starts with '/' right
+there, where cJSON_MinifyWithLength doesn't; bodies here never start with one. Returns how many failed. */
+static const PFCHAR *minify_texts[]={
+	_T("{ \"a/b\" : \"//not a comment\", \"c\":\"/* nor this */\" } // but this\n[1,\t2]"),
+	_T("[\"\\\\\", \"\\\"/\\/\", /* \"in a comment\" \\ */ \"end\\\\\"]"),
+	_T("\t\r\n/**/ /***/ /* ** / */\"\\\"\" // \"\n\"x\""),
+	_T("{\"k\":\"  spaces  and\ttabs  \",\"l\":[ { } , [ ] ] }")};
+static const PFCHAR *minify_pieces[]={_T(" "),_T("\t"),_T("\r\n"),_T("// c / \\ \" * \n"),_T("/* c // \\ \" / ** */"),_T("\"a b\""),
+	_T("\"/\""),_T("\"//\""),_T("\"/*\""),_T("\"\\\\\""),_T("\"\\\"\""),_T("\"\\/\""),_T("\"\\\\/*\""),_T("["),_T("]"),_T(":"),_T(","),_T("1.5"),_T("null")};
+static int minify_check(const PFCHAR *text)
+{
+	size_t length=strlen(text),n;PFCHAR *want=(PFCHAR*)malloc((length+1)*sizeof(PFCHAR)),*got=(PFCHAR*)malloc((length+1)*sizeof(PFCHAR));int ok;
+	memcpy(want,text,(length+1)*sizeof(PFCHAR));loop_minify(want);
+	memcpy(got,text,(length+1)*sizeof(PFCHAR));cJSON_Minify(got);ok=!strcmp(got,want);
+	memcpy(got,text,(length+1)*sizeof(PFCHAR));n=cJSON_MinifyWithLength(got,length);ok=ok && n==strlen(want) && !memcmp(got,want,n*sizeof(PFCHAR));
+	if (!ok) wprintf(_T("minified differently: %s\n"),text);
+	free(want);free(got);
+	return !ok;
+}
+int minify_matches()
+{
+	PFCHAR text[1024];int i,j,k,failures=0;size_t o;unsigned long r=7;
+	for (i=0;i<(int)(sizeof(minify_texts)/sizeof(*minify_texts));i++) for (j=0;j<32;j++)
+	{
+		for (o=0;o<(size_t)j;o++) text[o]=_T(' ');	/* shift it across the blocks. */
+		memcpy(text+o,minify_texts[i],(strlen(minify_texts[i])+1)*sizeof(PFCHAR));
+		failures+=minify_check(text);
+	}
+	for (i=0;i<20000;i++)
+	{
+		for (o=0,k=(int)(i%40)+1;k>0;k--)
+		{
+			r=r*1103515245UL+12345UL;j=(int)((r>>16)%(sizeof(minify_pieces)/sizeof(*minify_pieces)));
+			memcpy(text+o,minify_pieces[j],strlen(minify_pieces[j])*sizeof(PFCHAR));o+=strlen(minify_pieces[j]);
+		}
+		text[o]=0;
+		failures+=minify_check(text);
+	}
+	wprintf(_T("minify: %d failures\n"),failures);
+	return failures;
+}
+
+/* Eight threads parse, change, duplicate, print and delete at once, each through a context of its own with its own
+counting allocator. The global hooks count too: nothing a context does may reach them, and every allocator must end
+with no live blocks. */
+#define STRESS_THREADS 8
+#define STRESS_ROUNDS 2000
+static long stress_live[STRESS_THREADS+1];	/* the last is the global hooks'. */
+#define STRESS_HOOKS(n) \
+static void *stress_malloc##n(size_t sz)	{void *p=malloc(sz);if (p) stress_live[n]++;return p;} \
+static void stress_free##n(void *p)		{if (p) stress_live[n]--;free(p);}
+STRESS_HOOKS(0) STRESS_HOOKS(1) STRESS_HOOKS(2) STRESS_HOOKS(3) STRESS_HOOKS(4) STRESS_HOOKS(5) STRESS_HOOKS(6) STRESS_HOOKS(7) STRESS_HOOKS(8)
+static cJSON_Hooks stress_hooks[STRESS_THREADS+1]={{stress_malloc0,stress_free0},{stress_malloc1,stress_free1},{stress_malloc2,stress_free2},
+	{stress_malloc3,stress_free3},{stress_malloc4,stress_free4},{stress_malloc5,stress_free5},{stress_malloc6,stress_free6},
+	{stress_malloc7,stress_free7},{stress_malloc8,stress_free8}};
+typedef struct {int n,failures;} stress_job;
+static const PFCHAR stress_text[]=_T("{\"id\":17,\"name\":\"Jack (\\\"Bee\\\") Nimble\",\"tags\":[\"a\",\"b\",{\"deep\":[1,2.5,-3e10]}],\"ok\":true}");
+static const PFCHAR stress_expect[]=_T("{\"id\":17,\"name\":\"Jack (\\\"Bee\\\") Nimble\",\"tags\":[\"a\",\"b\",{\"deep\":[1,2.5,-30000000000]}],\"ok\":true,\"thread\":\"x\"}");
+static const PFCHAR stress_bad[]=_T("{\"id\":17,\n\"name\":nope}");
+
+static void *stress_worker(void *arg)
+{
+	stress_job *job=(stress_job*)arg;cJSON_Context ctx;cJSON *root,*copy;PFCHAR *out;int i;
+	cJSON_InitContext(&ctx,&stress_hooks[job->n]);
+	for (i=0;i<STRESS_ROUNDS;i++)
+	{
+		root=cJSON_ParseWithContext(&ctx,stress_text,0);
+		cJSON_AddItemToObjectWithContext(&ctx,root,_T("thread"),cJSON_CreateStringWithContext(&ctx,_T("x")));
+		copy=cJSON_DuplicateWithContext(&ctx,root,1);
+		out=cJSON_PrintWithContext(&ctx,copy,0);
+		if (!root || !copy || !out || strcmp(out,stress_expect)) job->failures++;
+		ctx.hooks.free_fn(out);
+		cJSON_DeleteWithContext(&ctx,copy);
+		cJSON_DeleteWithContext(&ctx,root);
+		/* Each thread's error report is its own. */
+		if (cJSON_ParseWithContext(&ctx,stress_bad,0) || ctx.error_ptr!=stress_bad+17 || ctx.error_line!=2 || ctx.error_column!=8) job->failures++;
+	}
+	return 0;
+}
+#if !defined(CJSON_NO_THREADS) && defined(_WIN32)
+static DWORD WINAPI stress_thread(LPVOID arg) {stress_worker(arg);return 0;}
+#endif
+
+int stress_contexts()
+{
+	stress_job jobs[STRESS_THREADS];int i,failures=0;long live=0;
+#if !defined(CJSON_NO_THREADS) && defined(_WIN32)
+	HANDLE threads[STRESS_THREADS];
+#elif !defined(CJSON_NO_THREADS)
+	pthread_t threads[STRESS_THREADS];
+#endif
+	cJSON_InitHooks(&stress_hooks[STRESS_THREADS]);
+	for (i=0;i<STRESS_THREADS;i++)
+	{
+		jobs[i].n=i;jobs[i].failures=0;
+#if !defined(CJSON_NO_THREADS) && defined(_WIN32)
+		threads[i]=CreateThread(0,0,stress_thread,&jobs[i],0,0);
+#elif !defined(CJSON_NO_THREADS)
+		pthread_create(&threads[i],0,stress_worker,&jobs[i]);
+#else
+		stress_worker(&jobs[i]);
+#endif
+	}
+	for (i=0;i<STRESS_THREADS;i++)
+	{
+#if !defined(CJSON_NO_THREADS) && defined(_WIN32)
+		WaitForSingleObject(threads[i],INFINITE);CloseHandle(threads[i]);
+#elif !defined(CJSON_NO_THREADS)
+		pthread_join(threads[i],0);
+#endif
+		failures+=jobs[i].failures;
+	}
+	cJSON_InitHooks(0);
+	for (i=0;i<=STRESS_THREADS;i++) live+=stress_live[i]<0?-stress_live[i]:stress_live[i];
+	wprintf(_T("%d threads: %d failures, %ld live blocks\n"),STRESS_THREADS,failures,live);
+	return failures || live;
+}
+
 int main (int argc, const char * argv[]) {
+	int failures=0;
 	/* a bunch of json: */
 	PFCHAR text1[]=_T("{\n\"name\": \"Jack (\\\"Bee\\\") Nimble\", \n\"format\": {\"type\":       \"rect\", \n\"width\":      1920, \n\"height\":     1080, \n\"interlace\":  false,\"frame rate\": 24\n}\n}");
 	PFCHAR text2[]=_T("[\"Sunday\", \"Monday\", \"Tuesday\", \"Wednesday\", \"Thursday\", \"Friday\", \"Saturday\"]");
@@ -170,6 +642,29 @@ int main (int argc, const char * argv[]) {
 
 	/* Now some samplecode for building objects concisely: */
 	create_objects();
-	
-	return 0;
+
+	/* And nesting deeper than any C stack would allow: */
+	failures+=deep_nesting();
+
+	/* Numbers that read back exactly: */
+	failures+=number_round_trip();
+
+	/* Streams cut into chunks anywhere: */
+	failures+=sax_chunks();
+
+	/* Fields found without building the whole tree: */
+	failures+=paths_and_projections();
+
+	/* The same tree whichever way it is read: */
+	failures+=representations();
+
+	/* Read without a tree: */
+	failures+=read_only_forms();
+
+	/* Minified as the character loop did: */
+	failures+=minify_matches();
+
+	/* And contexts used from many threads at once: */
+	failures+=stress_contexts();
+	return failures!=0;
 }